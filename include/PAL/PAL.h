@@ -2,14 +2,120 @@
 #define OKAPI_PAL
 
 #ifdef DEBUG
+#include "PAL/simPAL.h"
 #else
 #include <API.h>
 #endif
 
 namespace okapi {
+    //Block time which waits forever, for mutexTake and semaphoreTake on either backend (PROS
+    //takes -1, and its API.h has no name for it)
+    constexpr unsigned long maxDelay = static_cast<unsigned long>(-1);
+
     class PAL {
     public:
         #ifdef DEBUG
+        //Host build, served by the simulated Cortex in src/PAL/simPAL.cpp (see PAL/simPAL.h)
+        static bool isAutonomous();
+        static bool isEnabled();
+        static bool isJoystickConnected(unsigned char joystick);
+        static bool isOnline();
+        static int joystickGetAnalog(unsigned char joystick, unsigned char axis);
+        static bool joystickGetDigital(unsigned char joystick, unsigned char buttonGroup,unsigned char button);
+        static unsigned int powerLevelBackup();
+        static unsigned int powerLevelMain();
+        static void setTeamName(const char *name);
+        static int analogCalibrate(unsigned char channel);
+        static int analogRead(unsigned char channel);
+        static int analogReadCalibrated(unsigned char channel);
+        static int analogReadCalibratedHR(unsigned char channel);
+        static bool digitalRead(unsigned char pin);
+        static void digitalWrite(unsigned char pin, bool value);
+        static void pinMode(unsigned char pin, unsigned char mode);
+        static void ioClearInterrupt(unsigned char pin);
+        static void ioSetInterrupt(unsigned char pin, unsigned char edges, InterruptHandler handler);
+        static int motorGet(unsigned char channel);
+        static void motorSet(unsigned char channel, int speed);
+        static void motorStop(unsigned char channel);
+        static void motorStopAll();
+        static void speakerInit();
+        static void speakerPlayArray(const char * * songs);
+        static void speakerPlayRtttl(const char *song);
+        static void speakerShutdown();
+        static unsigned int imeInitializeAll();
+        static bool imeGet(unsigned char address, int *value);
+        static bool imeGetVelocity(unsigned char address, int *value);
+        static bool imeReset(unsigned char address);
+        static void imeShutdown();
+        static int gyroGet(Gyro gyro);
+        static Gyro gyroInit(unsigned char port, unsigned short multiplier);
+        static void gyroReset(Gyro gyro);
+        static void gyroShutdown(Gyro gyro);
+        static int encoderGet(Encoder enc);
+        static Encoder encoderInit(unsigned char portTop, unsigned char portBottom, bool reverse);
+        static void encoderReset(Encoder enc);
+        static void encoderShutdown(Encoder enc);
+        static int ultrasonicGet(Ultrasonic ult);
+        static Ultrasonic ultrasonicInit(unsigned char portEcho, unsigned char portPing);
+        static void ultrasonicShutdown(Ultrasonic ult);
+        static bool i2cRead(uint8_t addr, uint8_t *data, uint16_t count);
+        static bool i2cReadRegister(uint8_t addr, uint8_t reg, uint8_t *value, uint16_t count);
+        static bool i2cWrite(uint8_t addr, uint8_t *data, uint16_t count);
+        static bool i2cWriteRegister(uint8_t addr, uint8_t reg, uint16_t value);
+        static void usartInit(PROS_FILE *usart, unsigned int baud, unsigned int flags);
+        static void usartShutdown(PROS_FILE *usart);
+        static void fclose(PROS_FILE *stream);
+        static int fcount(PROS_FILE *stream);
+        static int fdelete(const char *file);
+        static int feof(PROS_FILE *stream);
+        static int fflush(PROS_FILE *stream);
+        static int fgetc(PROS_FILE *stream);
+        static char* fgets(char *str, int num, PROS_FILE *stream);
+        static PROS_FILE * fopen(const char *file, const char *mode);
+        static void fprint(const char *string, PROS_FILE *stream);
+        static int fputc(int value, PROS_FILE *stream);
+        static int fputs(const char *string, PROS_FILE *stream);
+        static size_t fread(void *ptr, size_t size, size_t count, PROS_FILE *stream);
+        static int fseek(PROS_FILE *stream, long int offset, int origin);
+        static long int ftell(PROS_FILE *stream);
+        static size_t fwrite(const void *ptr, size_t size, size_t count, PROS_FILE *stream);
+        static int getchar();
+        static void print(const char *string);
+        static int putchar(int value);
+        static int puts(const char *string);
+        static void lcdClear(PROS_FILE *lcdPort);
+        static void lcdInit(PROS_FILE *lcdPort);
+        static unsigned int lcdReadButtons(PROS_FILE *lcdPort);
+        static void lcdSetBacklight(PROS_FILE *lcdPort, bool backlight);
+        static void lcdSetText(PROS_FILE *lcdPort, unsigned char line, const char *buffer);
+        static void lcdShutdown(PROS_FILE *lcdPort);
+        static TaskHandle taskCreate(TaskCode taskCode, const unsigned int stackDepth, void *parameters,const unsigned int priority);
+        static void taskDelay(const unsigned long msToDelay);
+        static void taskDelayUntil(unsigned long *previousWakeTime, const unsigned long cycleTime);
+        static void taskDelete(TaskHandle taskToDelete);
+        static unsigned int taskGetCount();
+        static unsigned int taskGetState(TaskHandle task);
+        static unsigned int taskPriorityGet(const TaskHandle task);
+        static void taskPrioritySet(TaskHandle task, const unsigned int newPriority);
+        static void taskResume(TaskHandle taskToResume);
+        static TaskHandle taskRunLoop(void (*fn)(void), const unsigned long increment);
+        static void taskSuspend(TaskHandle taskToSuspend);
+        static Semaphore semaphoreCreate();
+        static bool semaphoreGive(Semaphore semaphore);
+        static bool semaphoreTake(Semaphore semaphore, const unsigned long blockTime);
+        static void semaphoreDelete(Semaphore semaphore);
+        static Mutex mutexCreate();
+        static bool mutexGive(Mutex mutex);
+        static bool mutexTake(Mutex mutex, const unsigned long blockTime);
+        static void mutexDelete(Mutex mutex);
+        static void delay(const unsigned long time);
+        static void delayMicroseconds(const unsigned long us);
+        static unsigned long micros();
+        static unsigned long millis();
+        static void wait(const unsigned long time);
+        static void waitUntil(unsigned long *previousWakeTime, const unsigned long time);
+        static void watchdogInit();
+        static void standaloneModeEnable();
         #else
         __attribute__((always_inline))
         static bool isAutonomous() { return ::isAutonomous(); }
@@ -0,0 +1,152 @@
+#ifndef OKAPI_SIMPAL
+#define OKAPI_SIMPAL
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+//Host replacements for the parts of API.h okapi uses. The values match PROS so code written
+//against the PAL behaves the same on the host as it does on the Cortex.
+#define JOY_DOWN 1
+#define JOY_LEFT 2
+#define JOY_UP 4
+#define JOY_RIGHT 8
+#define ACCEL_X 5
+#define ACCEL_Y 6
+
+#define BOARD_NR_ADC_PINS 8
+#define BOARD_NR_GPIO_PINS 27
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x0A
+#define INPUT_ANALOG 0x00
+#define INPUT_FLOATING 0x04
+#define OUTPUT 0x01
+#define OUTPUT_OD 0x05
+
+#define INTERRUPT_EDGE_RISING 1
+#define INTERRUPT_EDGE_FALLING 2
+#define INTERRUPT_EDGE_BOTH 3
+
+#define IME_ADDR_MAX 0x1F
+#define ULTRA_BAD_RESPONSE -1
+
+#define LCD_BTN_LEFT 1
+#define LCD_BTN_CENTER 2
+#define LCD_BTN_RIGHT 4
+
+#define TASK_MAX 16
+#define TASK_MAX_PRIORITIES 6
+#define TASK_PRIORITY_LOWEST 0
+#define TASK_PRIORITY_DEFAULT 2
+#define TASK_PRIORITY_HIGHEST (TASK_MAX_PRIORITIES - 1)
+#define TASK_DEFAULT_STACK_SIZE 512
+#define TASK_MINIMAL_STACK_SIZE 64
+#define TASK_DEAD 0
+#define TASK_RUNNING 1
+#define TASK_RUNNABLE 2
+#define TASK_SLEEPING 3
+#define TASK_SUSPENDED 4
+
+typedef void (*InterruptHandler)(unsigned char pin);
+typedef void * Gyro;
+typedef void * Encoder;
+typedef void * Ultrasonic;
+typedef void * TaskHandle;
+typedef void * Mutex;
+typedef void * Semaphore;
+typedef void (*TaskCode)(void *);
+
+//Files are opaque so the UARTs can stay address constants (Button uses uart1 in a constexpr
+//constructor). Flash files are backed by host files in the working directory.
+struct SimFile;
+typedef SimFile PROS_FILE;
+extern PROS_FILE simUart1, simUart2;
+#define uart1 (&simUart1)
+#define uart2 (&simUart2)
+
+namespace okapi {
+  /**
+   * Control surface for the host PAL. Build with -DDEBUG (make sim) and every PAL call is served
+   * by a simulated Cortex: a virtual microsecond clock, motor ports, encoders, IMEs, gyros,
+   * ultrasonics, analog and digital pins, and cooperative tasks.
+   *
+   * Tasks only switch when the running task blocks (delay, taskDelay, taskDelayUntil, waiting on
+   * a mutex or semaphore), so a loop which never blocks will never let the clock advance. When
+   * every task is blocked, the clock jumps straight to the earliest wake time; ties go to the
+   * highest priority task, then round-robin.
+   */
+  class SimPAL {
+  public:
+    /**
+     * Kills every task, frees their stacks, and restores all devices and the clock to zero. Only
+     * call this from the main (harness) task
+     */
+    static void reset();
+
+    /**
+     * Runs the simulation for a period of virtual time. This is a delay from the main task, so
+     * every other task gets to run in the meantime
+     * @param ims Time to run for in ms
+     */
+    static void run(const unsigned long ims);
+
+    /**
+     * Returns the virtual time
+     * @return Time since the last reset in us
+     */
+    static unsigned long long getTime();
+
+    /**
+     * Sets a callback which models the robot. It is called every time the clock advances, in
+     * steps no longer than iperiod, and would normally read motor powers with PAL::motorGet and
+     * write sensor values back with the setters below
+     * @param iplant  Plant model; the argument is the time step in seconds
+     * @param iperiod Longest time step in us
+     */
+    static void setPlant(std::function<void(const float)> iplant, const unsigned long iperiod = 1000);
+
+    /**
+     * Sets the raw count of the quad encoder whose top wire is in a port. Reversal and resets are
+     * applied by encoderGet, like on the Cortex
+     */
+    static void setEncoder(const unsigned char iportTop, const int ival);
+
+    /**
+     * Sets the raw count and velocity of the IME at an address
+     */
+    static void setIME(const unsigned char iaddress, const int ival, const int ivel = 0);
+
+    /**
+     * Sets the heading in degrees of the gyro in a port
+     */
+    static void setGyro(const unsigned char iport, const int ival);
+
+    /**
+     * Sets the range in cm of the ultrasonic whose echo wire is in a port
+     */
+    static void setUltrasonic(const unsigned char iportEcho, const int ival);
+
+    /**
+     * Sets the 12-bit value of an analog channel (1-8)
+     */
+    static void setAnalog(const unsigned char ichannel, const int ival);
+
+    /**
+     * Sets the level of a digital pin. Interrupt handlers registered on the pin fire on matching
+     * edges, in the caller's context
+     */
+    static void setDigital(const unsigned char ipin, const bool ival);
+
+    static void setJoystickAnalog(const unsigned char ijoystick, const unsigned char iaxis, const int ival);
+    static void setJoystickDigital(const unsigned char ijoystick, const unsigned char ibuttonGroup, const unsigned char ibutton, const bool ival);
+    static void setLCDButtons(const unsigned int ival);
+    static const char* getLCDText(PROS_FILE *ilcdPort, const unsigned char iline);
+    static void setCompetitionState(const bool iisEnabled, const bool iisAutonomous, const bool iisOnline = true);
+    static void setBatteryLevels(const unsigned int imain, const unsigned int ibackup = 0);
+  private:
+    SimPAL() {}
+  };
+}
+
+#endif /* end of include guard: OKAPI_SIMPAL */
@@ -3,7 +3,13 @@
 
 #include "chassis/chassisModel.h"
 #include "control/pid.h"
+#include "control/feedforwardVelController.h"
+#include "control/motionProfile.h"
 #include "odometry/odometry.h"
+#include "util/timer.h"
+#include "PAL/PAL.h"
+#include <atomic>
+#include <cstdint>
 #include <memory>
 
 namespace okapi {
@@ -40,27 +46,89 @@ namespace okapi {
     void leftTS(const int val) { model->leftTS(val); }
     void right(const int val) { model->right(val); }
     void rightTS(const int val) { model->rightTS(val); }
-    std::valarray<int> getSensorVals() { return model->getSensorVals(); }
+    std::array<int, 2> getSensorVals() { return model->getSensorVals(); }
   protected:
     std::shared_ptr<ChassisModel> model;
   };
 
+  class ChassisControllerPid;
+
+  /**
+   * Handle to a motion started by one of ChassisControllerPid's async methods
+   */
+  class AsyncMotion {
+  public:
+    AsyncMotion(ChassisControllerPid& icontroller, const std::uint32_t iid):
+      controller(&icontroller),
+      id(iid) {}
+
+    /**
+     * Returns whether the motion is over: it settled, was cancelled, or was replaced by a newer
+     * motion
+     * @return True if the motion is over
+     */
+    bool isSettled() const;
+
+    /**
+     * Blocks until the motion is over or a timeout passes
+     * @param  itimeout Longest time to wait in ms
+     * @return          True if the motion is over, false if the timeout passed first
+     */
+    bool waitUntilSettled(const unsigned long itimeout = maxDelay) const;
+
+    /**
+     * Stops the motion and the drive if it is still running. Does nothing otherwise
+     */
+    void cancel();
+  private:
+    ChassisControllerPid* controller;
+    std::uint32_t id;
+  };
+
   class ChassisControllerPid : public virtual ChassisController {
   public:
     ChassisControllerPid(const ChassisModelParams& imodelParams, const PidParams& idistanceParams, const PidParams& iangleParams):
       ChassisController(imodelParams),
       distancePid(idistanceParams),
-      anglePid(iangleParams) {}
+      anglePid(iangleParams),
+      distanceProfile(MotionProfileParams(0, 0)),
+      isProfiled(false),
+      profileFeedforward(),
+      profileStart(0),
+      mode(MotionMode::none),
+      nextMode(MotionMode::none),
+      motionTarget(0),
+      nextTarget(0),
+      encStartVals{{0, 0}},
+      lastValue(0),
+      motionTask(nullptr),
+      motionMutex(nullptr),
+      motionId(0),
+      settledId(0) {}
 
     ChassisControllerPid(const std::shared_ptr<ChassisModel>& imodel, const PidParams& idistanceParams, const PidParams& iangleParams):
       ChassisController(imodel),
       distancePid(idistanceParams),
-      anglePid(iangleParams) {}
+      anglePid(iangleParams),
+      distanceProfile(MotionProfileParams(0, 0)),
+      isProfiled(false),
+      profileFeedforward(),
+      profileStart(0),
+      mode(MotionMode::none),
+      nextMode(MotionMode::none),
+      motionTarget(0),
+      nextTarget(0),
+      encStartVals{{0, 0}},
+      lastValue(0),
+      motionTask(nullptr),
+      motionMutex(nullptr),
+      motionId(0),
+      settledId(0) {}
 
-      virtual ~ChassisControllerPid() {
-        delete &distancePid;
-        delete &anglePid;
-      }
+      /**
+       * Stops the motion task, and the drive if a motion is running
+       */
+      virtual ~ChassisControllerPid();
 
       /**
        * Drives the robot straight
@@ -73,8 +141,132 @@ namespace okapi {
        * @param idegTarget Degrees to turn for
        */
       void pointTurn(float idegTarget) override;
+
+      /**
+       * Starts driving the robot straight and returns immediately. The motion runs in a
+       * background task (spun up at the default priority plus 1 on first use) and replaces any
+       * motion already running
+       * @param  itarget Distance to travel
+       * @return         Handle to the motion
+       */
+      AsyncMotion driveStraightAsync(const int itarget);
+
+      /**
+       * Starts turning the robot clockwise in place and returns immediately. Replaces any motion
+       * already running
+       * @param  idegTarget Degrees to turn for
+       * @return            Handle to the motion
+       */
+      AsyncMotion pointTurnAsync(float idegTarget);
+
+      /**
+       * Returns whether the most recent motion is over
+       * @return True if no motion is running
+       */
+      bool isSettled() const { return isSettled(motionId.load()); }
+
+      /**
+       * Blocks until the most recent motion is over or a timeout passes
+       * @param  itimeout Longest time to wait in ms
+       * @return          True if the motion is over, false if the timeout passed first
+       */
+      bool waitUntilSettled(const unsigned long itimeout = maxDelay) const { return waitUntilSettled(motionId.load(), itimeout); }
+
+      /**
+       * Stops the running motion, if any, and the drive
+       */
+      void cancel() { cancel(motionId.load()); }
+
+      /**
+       * Makes driveStraight follow a motion profile instead of stepping the distance target. The
+       * distance controller tracks the profile's position and its output gets static friction,
+       * velocity, and acceleration feedforward added (see VelFeedforward). Pass a max velocity
+       * of 0 to go back to step targets
+       * @param iparams Profile limits in encoder ticks per second (squared, cubed)
+       * @param ikV     Motor power per tick per second of profile velocity
+       * @param ikA     Motor power per tick per second squared of profile acceleration
+       * @param ikS     Motor power to get moving, in the direction of the profile
+       */
+      void setDistanceProfile(const MotionProfileParams& iparams, const float ikV = 0, const float ikA = 0, const float ikS = 0);
+
+      static void trampoline(void *context) { static_cast<ChassisControllerPid*>(context)->loop(); }
   protected:
+    friend class AsyncMotion;
+
+    enum class MotionMode { none, distance, angle, path, heading };
+
     Pid distancePid, anglePid;
+
+    MotionProfile distanceProfile;
+    bool isProfiled;
+    VelFeedforward profileFeedforward;
+    unsigned long profileStart; //PAL::millis when the profile started
+
+    //State of the running motion. Guarded by motionMutex once the motion task exists
+    MotionMode mode, nextMode;
+    float motionTarget, nextTarget;
+    std::array<int, 2> encStartVals;
+    float lastValue;
+    Timer atTargetTimer;
+
+    TaskHandle motionTask;
+    Mutex motionMutex;
+    std::atomic<std::uint32_t> motionId, settledId; //A motion is over once settledId reaches its id
+
+    /**
+     * Replaces the running motion with a new one, optionally followed by a second one
+     * @param  imode       First motion
+     * @param  itarget     Target of the first motion
+     * @param  inextMode   Motion to start once the first settles
+     * @param  inextTarget Target of the second motion
+     * @return             Handle to the motion
+     */
+    AsyncMotion startMotion(const MotionMode imode, const float itarget, const MotionMode inextMode = MotionMode::none, const float inextTarget = 0);
+
+    /**
+     * startMotion for callers which already hold motionMutex, so they can set up state the new
+     * motion reads without the motion task stepping the old motion in between
+     */
+    AsyncMotion startMotionLocked(const MotionMode imode, const float itarget, const MotionMode inextMode = MotionMode::none, const float inextTarget = 0);
+
+    /**
+     * Spins up the motion task and its mutex if they do not exist yet
+     */
+    void ensureMotionTask();
+
+    /**
+     * Stops the motion task, and the drive if a motion is running, and frees the task's mutex.
+     * Subclasses which override motionStep call this from their destructors, so the task never
+     * steps a half-destroyed controller
+     */
+    void deleteMotionTask();
+
+    /**
+     * Resets the controllers and sensor offsets for the motion in mode
+     */
+    virtual void beginMotion();
+
+    /**
+     * Does one iteration of the running motion
+     * @return True once the motion has settled
+     */
+    virtual bool motionStep();
+
+    /**
+     * Steers a distance motion to keep the robot straight
+     * @param  iangleChange Clockwise encoder difference since the motion started
+     * @return              Angle power for driveVector (clockwise positive)
+     */
+    virtual float holdAngle(const float iangleChange) { return anglePid.step(iangleChange); }
+
+    /**
+     * Run motions in an infinite loop
+     */
+    void loop();
+
+    bool isSettled(const std::uint32_t iid) const { return settledId.load() >= iid; }
+    bool waitUntilSettled(const std::uint32_t iid, const unsigned long itimeout) const;
+    void cancel(const std::uint32_t iid);
   };
 }
 
@@ -2,8 +2,8 @@
 #define OKAPI_CHASSISMODEL
 
 #include <array>
+#include <cmath>
 #include <initializer_list>
-#include <valarray>
 #include <memory>
 #include "device/ime.h"
 #include "device/motor.h"
@@ -25,7 +25,12 @@ namespace okapi {
     virtual void leftTS(const int val) = 0;
     virtual void right(const int val) = 0;
     virtual void rightTS(const int val) = 0;
-    virtual std::valarray<int> getSensorVals() = 0;
+    /**
+     * Read the sensors. Returns by value in a fixed-size array so the 15 ms loops which call this
+     * never touch the heap
+     * @return {left sensor value, right sensor value}
+     */
+    virtual std::array<int, 2> getSensorVals() = 0;
     virtual void resetSensors() = 0;
   };
 
@@ -57,6 +62,11 @@ namespace okapi {
       leftSensor(std::make_shared<IME>(ileftIME)),
       rightSensor(std::make_shared<IME>(irightIME)) {}
 
+    SkidSteerModelParams(const std::array<Motor, motorsPerSide * 2>& imotorList, const std::shared_ptr<RotarySensor>& ileftSensor, const std::shared_ptr<RotarySensor>& irightSensor):
+      motorList(imotorList),
+      leftSensor(ileftSensor),
+      rightSensor(irightSensor) {}
+
     virtual ~SkidSteerModelParams() = default;
 
     std::shared_ptr<ChassisModel> make() const override {
@@ -96,6 +106,19 @@ namespace okapi {
       leftSensor(std::make_shared<IME>(ileftIME)),
       rightSensor(std::make_shared<IME>(irightIME)) {}
 
+    /**
+     * Model for a skid steer drive (wheels parallel with robot's direction of
+     * motion). When all motors are powered +127, the robot should move forward
+     * in a straight line at full speed.
+     * @param imotors      Motors in the format: {{left side motors}, {right side motors}}
+     * @param ileftSensor  Left side sensor
+     * @param irightSensor Right side sensor
+     */
+    SkidSteerModel(const std::array<Motor, motorsPerSide * 2>& imotorList, const std::shared_ptr<RotarySensor>& ileftSensor, const std::shared_ptr<RotarySensor>& irightSensor):
+      motors(imotorList),
+      leftSensor(ileftSensor),
+      rightSensor(irightSensor) {}
+
     SkidSteerModel(const SkidSteerModelParams<motorsPerSide>& iparams):
       motors(iparams.motorList),
       leftSensor(iparams.leftSensor),
@@ -106,7 +129,7 @@ namespace okapi {
       leftSensor(other.leftSensor),
       rightSensor(other.rightSensor) {}
 
-    virtual ~SkidSteerModel() { delete &motors; }
+    virtual ~SkidSteerModel() = default;
 
     void driveForward(const int power) override {
       for (size_t i = 0; i < motorsPerSide * 2; i++)
@@ -186,8 +209,8 @@ namespace okapi {
         motors[i].setTS(val);
     }
 
-    std::valarray<int> getSensorVals() override {
-      return std::valarray<int>{leftSensor->get(), rightSensor->get()};
+    std::array<int, 2> getSensorVals() override {
+      return std::array<int, 2>{{leftSensor->get(), rightSensor->get()}};
     }
 
     void resetSensors() override {
@@ -215,6 +238,11 @@ namespace okapi {
       leftSensor(std::make_shared<IME>(ileftIME)),
       rightSensor(std::make_shared<IME>(irightIME)) {}
 
+    XDriveModelParams(const std::array<unsigned char, motorsPerCorner * 4>& imotorList, const std::shared_ptr<RotarySensor>& ileftSensor, const std::shared_ptr<RotarySensor>& irightSensor):
+      motorList(imotorList),
+      leftSensor(ileftSensor),
+      rightSensor(irightSensor) {}
+
     virtual ~XDriveModelParams() {}
 
     std::shared_ptr<ChassisModel> make() const override {
@@ -254,6 +282,19 @@ namespace okapi {
       leftSensor(std::make_shared<IME>(ileftIME)),
       rightSensor(std::make_shared<IME>(irightIME)) {}
 
+    /**
+     * Model for an x drive (wheels at 45 deg from a skid steer drive). When all
+     * motors are powered +127, the robot should move forward in a straight line
+     * at full speed.
+     * @param imotors Motors in the format: {{top left motors}, {top right motors}, {bottom right motors}, {bottom left motors}}
+     * @param ileftSensor Left side sensor
+     * @param irightSensor Right side sensor
+     */
+    XDriveModel(const std::array<unsigned char, motorsPerCorner * 4>& imotorList, const std::shared_ptr<RotarySensor>& ileftSensor, const std::shared_ptr<RotarySensor>& irightSensor):
+      motors(imotorList),
+      leftSensor(ileftSensor),
+      rightSensor(irightSensor) {}
+
     XDriveModel(const XDriveModelParams<motorsPerCorner>& iparams):
       motors(iparams.motorList),
       leftSensor(iparams.leftSensor),
@@ -264,7 +305,7 @@ namespace okapi {
       leftSensor(other.leftSensor),
       rightSensor(other.rightSensor) {}
 
-    virtual ~XDriveModel() { delete &motors; }
+    virtual ~XDriveModel() = default;
 
     void driveForward(const int power) override {
       for (size_t i = 0; i < motorsPerCorner * 4; i++)
@@ -388,8 +429,8 @@ namespace okapi {
         motors[i].setTS(val);
     }
 
-    std::valarray<int> getSensorVals() override {
-      return std::valarray<int>{leftSensor->get(), rightSensor->get()};
+    std::array<int, 2> getSensorVals() override {
+      return std::array<int, 2>{{leftSensor->get(), rightSensor->get()}};
     }
 
     void resetSensors() override {
@@ -1,7 +1,9 @@
 #ifndef OKAPI_ODOMCHASSISCONTROLLER
 #define OKAPI_ODOMCHASSISCONTROLLER
 
+#include <initializer_list>
 #include "odometry/odometry.h"
+#include "odometry/purePursuit.h"
 #include "chassis/chassisController.h"
 
 namespace okapi {
@@ -9,16 +11,17 @@ namespace okapi {
   public:
     /**
      * Odometry based chassis controller. Spins up a task at the default
-     * priority plus 1 for odometry when constructed
+     * priority plus 1 for odometry when constructed, and stops it when destroyed
      * @param iparams Odometry parameters for the internal odometry math
      */
     OdomChassisController(const OdomParams& iparams):
       ChassisController(iparams.model),
-      odom(iparams) {
-        taskCreate((TaskCode)Odometry::trampoline, TASK_DEFAULT_STACK_SIZE, &odom, TASK_PRIORITY_DEFAULT + 1);
+      odom(iparams),
+      odomTask(nullptr) {
+        odomTask = PAL::taskCreate((TaskCode)Odometry::trampoline, TASK_DEFAULT_STACK_SIZE, &odom, TASK_PRIORITY_DEFAULT + 1);
       }
 
-    virtual ~OdomChassisController() = default;
+    virtual ~OdomChassisController() { PAL::taskDelete(odomTask); }
 
     /**
      * Drives the robot straight to a point in the odom frame
@@ -37,20 +40,37 @@ namespace okapi {
      * Passthrough to internal Odometry object
      * @return State from internal Odometry object
      */
-    OdomState getState() { return odom.getState(); }
+    OdomState getState() const { return odom.getState(); }
   protected:
     static constexpr int moveThreshold = 10; //Minimum length movement
     Odometry odom;
+  private:
+    TaskHandle odomTask;
   };
 
   class OdomChassisControllerPid : public OdomChassisController, public ChassisControllerPid {
   public:
-    OdomChassisControllerPid(const OdomParams& params, const PidParams& idistanceParams, const PidParams& iangleParams):
+    /**
+     * PID chassis controller which turns and holds headings with odometry
+     * @param params          Odometry parameters for the internal odometry math
+     * @param idistanceParams Distance controller, on encoder ticks
+     * @param iangleParams    Controller keeping pointTurn and driveStraight straight, on the
+     *                        encoder difference
+     * @param ipathParams     Path follower parameters
+     * @param iheadingParams  Controller for turnToAngle and for holding the field heading while
+     *                        driving, on degrees of heading error
+     */
+    OdomChassisControllerPid(const OdomParams& params, const PidParams& idistanceParams, const PidParams& iangleParams, const PurePursuitParams& ipathParams = PurePursuitParams(300, 304.8), const PidParams& iheadingParams = PidParams(3, 0, 0.15)):
       ChassisController(params.model),
       OdomChassisController(params),
-      ChassisControllerPid(params.model, idistanceParams, iangleParams) {}
+      ChassisControllerPid(params.model, idistanceParams, iangleParams),
+      pathParams(ipathParams),
+      pursuit(ipathParams),
+      headingPid(iheadingParams),
+      heldHeading(0),
+      hasHeldHeading(false) {}
 
-    virtual ~OdomChassisControllerPid() = default;
+    virtual ~OdomChassisControllerPid() { deleteMotionTask(); }
 
     /**
      * Drives the robot straight to a point in the odom frame
@@ -60,10 +80,79 @@ namespace okapi {
     void driveToPoint(const float ix, const float iy, const bool ibackwards = false, const float ioffset = 0) override;
 
     /**
-     * Turns the robot to face an angle in the odom frame
-     * @param iangle Angle to turn to
+     * Turns the robot the short way around to face an angle in the odom frame. The turn is
+     * controlled on the odometry heading (fused with the gyro, if any), and later drives hold
+     * that heading
+     * @param iangle Angle to turn to in degrees, counterclockwise from the x axis
      */
     void turnToAngle(const float iangle) override;
+
+    /**
+     * Starts driving the robot straight to a point in the odom frame and returns immediately.
+     * The turn and the drive run back to back in the motion task
+     * @param  ix X coordinate
+     * @param  iy Y coordinate
+     * @return    Handle to the motion
+     */
+    AsyncMotion driveToPointAsync(const float ix, const float iy, const bool ibackwards = false, const float ioffset = 0);
+
+    /**
+     * Starts turning the robot to face an angle in the odom frame and returns immediately
+     * @param  iangle Angle to turn to in degrees, counterclockwise from the x axis
+     * @return        Handle to the motion
+     */
+    AsyncMotion turnToAngleAsync(const float iangle);
+
+    /**
+     * Follows a path through waypoints in the odom frame with pure pursuit, without stopping at
+     * any of them
+     * @param  iwaypoints Waypoints to drive through
+     * @param  itimeout   Time to give up and stop the robot after in ms
+     * @return            False if it timed out
+     */
+    bool followPath(std::initializer_list<Waypoint> iwaypoints, const unsigned long itimeout = 15000);
+
+    /**
+     * Starts following a path through waypoints in the odom frame and returns immediately
+     * @param  iwaypoints Waypoints to drive through
+     * @return            Handle to the motion
+     */
+    AsyncMotion followPathAsync(std::initializer_list<Waypoint> iwaypoints);
+
+    /**
+     * Sets the path follower parameters. Takes effect on the next path
+     * @param iparams Path follower parameters
+     */
+    void setPathParams(const PurePursuitParams& iparams) { pathParams = iparams; }
+
+    static constexpr float maxHeldHeadingError = 15; //Drives hold the last commanded heading only if within this
+  protected:
+    PurePursuitParams pathParams;
+    PurePursuit pursuit; //Guarded by motionMutex
+    Pid headingPid;
+
+    //Field heading in degrees drives hold, set by the last turnToAngle or driveToPoint and kept
+    //through driveStraight calls. Guarded by motionMutex
+    float heldHeading;
+    bool hasHeldHeading;
+
+    /**
+     * Starts a motion with a field heading for distance motions to hold
+     * @param  iheading Heading in degrees
+     * @return          Handle to the motion
+     */
+    AsyncMotion startHeldMotion(const float iheading, const MotionMode imode, const float itarget, const MotionMode inextMode = MotionMode::none, const float inextTarget = 0);
+
+    /**
+     * Returns the heading error, the short way around
+     * @param  iheading Field heading in degrees
+     * @return          Degrees the robot must turn counterclockwise to face iheading, in (-180, 180]
+     */
+    float headingError(const float iheading) const;
+
+    void beginMotion() override;
+    bool motionStep() override;
+    float holdAngle(const float iangleChange) override;
   };
 }
 
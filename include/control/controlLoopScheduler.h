@@ -0,0 +1,132 @@
+#ifndef OKAPI_CONTROLLOOPSCHEDULER
+#define OKAPI_CONTROLLOOPSCHEDULER
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include "control/controlObject.h"
+#include "control/genericController.h"
+#include "odometry/odometry.h"
+#include "PAL/PAL.h"
+
+namespace okapi {
+  class ControlLoopScheduler {
+  public:
+    static constexpr std::size_t maxLoops = 16;
+
+    /**
+     * Runs every registered control loop from one task instead of one task per loop. Loops are
+     * run rate monotonic: whenever several are due at once, the one with the shortest period
+     * goes first. Each loop is handed the time since it last ran, measured in us, so controllers
+     * integrate and differentiate over the real time step instead of assuming their sample time.
+     * Register loops, then call start()
+     */
+    ControlLoopScheduler():
+      count(0),
+      isStarted(false) {}
+
+    /**
+     * Registers a loop. Must be called before start()
+     * @param  iloop   Loop body; the argument is the time since it last ran in ms
+     * @param  iperiod Period in ms
+     * @return         Index of the loop, or -1 if there is no room
+     */
+    int add(std::function<void(const float)> iloop, const unsigned long iperiod);
+
+    /**
+     * Registers a controller. Each period it is stepped with a fresh reading and the real time
+     * step, and its output is handed to ioutput
+     * @param  icontroller Controller to step
+     * @param  ireading    Returns the controller's new measurement
+     * @param  ioutput     Consumes the controller's output (e.g. sets a motor)
+     * @param  iperiod     Period in ms
+     * @return             Index of the loop, or -1 if there is no room
+     */
+    int add(ControlObject& icontroller, std::function<float()> ireading, std::function<void(const float)> ioutput, const unsigned long iperiod);
+
+    /**
+     * Registers a GenericController. Each period it is stepped with a fresh reading and the real
+     * time step, and its motors are powered with the output
+     * @param  icontroller Controller to step
+     * @param  ireading    Returns the controller's new measurement
+     * @param  iperiod     Period in ms
+     * @return             Index of the loop, or -1 if there is no room
+     */
+    template<size_t motorNum>
+    int add(GenericController<motorNum>& icontroller, std::function<float()> ireading, const unsigned long iperiod) {
+      icontroller.setSampleTime(static_cast<int>(iperiod)); //So the gains are scaled for the nominal time step
+      return add([&icontroller, ireading](const float idt) { icontroller.stepDt(ireading(), idt); }, iperiod);
+    }
+
+    /**
+     * Registers odometry. Use this instead of starting Odometry::loop in its own task
+     * @param  iodom   Odometry to step
+     * @param  iperiod Period in ms
+     * @return         Index of the loop, or -1 if there is no room
+     */
+    int add(Odometry& iodom, const unsigned long iperiod = 15);
+
+    /**
+     * Runs every loop which is due, shortest period first
+     */
+    void step();
+
+    /**
+     * Run loops in an infinite loop
+     */
+    void loop();
+
+    static void trampoline(void *context) { static_cast<ControlLoopScheduler*>(context)->loop(); }
+
+    /**
+     * Spins up the scheduler task. Nothing can be added after this
+     * @param ipriority Task priority
+     */
+    void start(const unsigned int ipriority = TASK_PRIORITY_HIGHEST - 1);
+
+    /**
+     * Returns how many releases of a loop were missed because it, or a loop ahead of it, ran long
+     * @param  iindex Index returned by add
+     * @return        Number of missed releases
+     */
+    unsigned long getOverruns(const int iindex) const { return loops[static_cast<std::size_t>(iindex)].overruns; }
+
+    /**
+     * Returns how many releases were missed across every loop
+     * @return Number of missed releases
+     */
+    unsigned long getTotalOverruns() const;
+
+    /**
+     * Returns the longest time one iteration of a loop has taken
+     * @param  iindex Index returned by add
+     * @return        Longest execution time in us
+     */
+    unsigned long getMaxExecTime(const int iindex) const { return loops[static_cast<std::size_t>(iindex)].maxExecTime; }
+  private:
+    class Entry {
+    public:
+      Entry():
+        period(0),
+        nextRun(0),
+        lastRun(0),
+        overruns(0),
+        maxExecTime(0),
+        hasRun(false) {}
+
+      std::function<void(const float)> loop;
+      unsigned long period; //ms
+      unsigned long nextRun; //PAL::millis of the next release
+      unsigned long lastRun; //PAL::micros
+      unsigned long overruns, maxExecTime;
+      bool hasRun;
+    };
+
+    std::array<Entry, maxLoops> loops;
+    std::array<std::size_t, maxLoops> order; //Indices into loops sorted by period
+    std::size_t count;
+    bool isStarted;
+  };
+}
+
+#endif /* end of include guard: OKAPI_CONTROLLOOPSCHEDULER */
@@ -15,6 +15,15 @@ namespace okapi {
     */
     virtual float step(const float ireading) = 0;
 
+    /**
+    * Do one iteration of the controller with a time step measured by the caller,
+    * skipping the controller's own sample time check. Used by ControlLoopScheduler
+    * @param  ireading New measurement
+    * @param  idt      Time since the last iteration in ms
+    * @return          Controller output
+    */
+    virtual float stepDt(const float ireading, const float idt) = 0;
+
     /**
     * Sets the target for the controller
     */
@@ -34,25 +43,47 @@ namespace okapi {
     * Set time between loops in ms
     * @param isampleTime Time between loops in ms
     */
-    virtual void setSampleTime(const int isampleTime);
+    virtual void setSampleTime(const int isampleTime) = 0;
 
     /**
     * Set controller output bounds
     * @param imax Max output
     * @param imin Min output
     */
-    virtual void setOutputLimits(float imax, float imin);
+    virtual void setOutputLimits(float imax, float imin) = 0;
 
     /**
     * Resets the controller so it can start from 0 again properly. Keeps
     * configuration from before
     */
-    virtual void reset();
+    virtual void reset() = 0;
 
     /**
     * Turns the controller on or off
     */
-    virtual void flipDisable();
+    virtual void flipDisable() = 0;
+  protected:
+    /**
+    * Sample time check shared by the controllers' step(). Runs a little early rather than skip
+    * a whole period when the caller's task wakes up late on one iteration and on time on the
+    * next. A gap of more than two periods means the loop was paused (or this is the first
+    * iteration), so it counts as one period instead of integrating over the whole gap
+    * @param  inow        PAL::micros now
+    * @param  ilastTime   PAL::micros at the last iteration which ran
+    * @param  isampleTime Sample time in ms
+    * @param  odtRatio    Time step divided by the sample time, set if it is time to run
+    * @return             Whether it is time to run an iteration
+    */
+    static bool isStepDue(const unsigned long inow, const unsigned long ilastTime, const long isampleTime, float& odtRatio) {
+      const unsigned long dt = inow - ilastTime;
+      const unsigned long sampleTimeUs = static_cast<unsigned long>(isampleTime) * 1000;
+
+      if (dt + sampleTimeUs / 16 < sampleTimeUs)
+        return false;
+
+      odtRatio = dt > 2 * sampleTimeUs ? 1 : static_cast<float>(dt) / static_cast<float>(sampleTimeUs);
+      return true;
+    }
   };
 }
 
@@ -0,0 +1,152 @@
+#ifndef OKAPI_FEEDFORWARDVELCONTROLLER
+#define OKAPI_FEEDFORWARDVELCONTROLLER
+
+#include "control/controlObject.h"
+#include "control/motionProfile.h"
+#include "control/velMath.h"
+
+namespace okapi {
+  class VelFeedforward {
+  public:
+    /**
+     * Motor model feedforward: the power to overcome static friction, plus power proportional to
+     * the velocity (back-EMF and viscous friction), plus power proportional to the acceleration
+     * @param ikS Power to get moving, applied in the direction of motion
+     * @param ikV Power per unit per second of velocity
+     * @param ikA Power per unit per second squared of acceleration
+     */
+    VelFeedforward(const float ikS = 0, const float ikV = 0, const float ikA = 0):
+      kS(ikS),
+      kV(ikV),
+      kA(ikA) {}
+
+    /**
+     * Returns the feedforward power for a velocity and acceleration. The kS term follows the
+     * velocity, or the acceleration when starting from rest, and is 0 when neither is set
+     * @param  ivel   Velocity
+     * @param  iaccel Acceleration
+     * @return        Power
+     */
+    float calculate(const float ivel, const float iaccel) const {
+      const float direction = ivel != 0 ? ivel : iaccel;
+      const float friction = direction > 0 ? kS : (direction < 0 ? -kS : 0);
+      return friction + kV * ivel + kA * iaccel;
+    }
+
+    float kS, kV, kA;
+  };
+
+  class FeedforwardVelController : public ControlObject {
+  public:
+    /**
+     * Velocity controller which does most of the work with a VelFeedforward and corrects the
+     * rest with proportional and integral feedback on the velocity error. Readings are positions;
+     * velocities are in units of the reading per second (e.g. encoder ticks per second), the same
+     * as MotionProfile, so profile setpoints can be fed straight in with setSetpoint
+     * @param ifeedforward Feedforward gains
+     * @param ikP          Power per unit per second of velocity error
+     * @param ikI          Integral gain, per sample time
+     * @param ivelParams   Velocity math params (ticks per rev only has to match the one used for
+     *                     RPM; the output is converted back to units per second)
+     */
+    FeedforwardVelController(const VelFeedforward& ifeedforward, const float ikP, const float ikI = 0, const VelMathParams& ivelParams = VelMathParams(360));
+
+    virtual ~FeedforwardVelController() = default;
+
+    /**
+     * Do one iteration of the controller if a sample time has passed since the last one
+     * @param  inewReading New position
+     * @return             Controller output
+     */
+    float step(const float inewReading) override;
+
+    /**
+     * Do one iteration of the controller with a time step measured by the caller
+     * @param  inewReading New position
+     * @param  idt         Time since the last iteration in ms
+     * @return             Controller output
+     */
+    float stepDt(const float inewReading, const float idt) override;
+
+    /**
+     * Sets a target velocity to hold (no acceleration)
+     * @param itarget Target velocity
+     */
+    void setTarget(const float itarget) override { setSetpoint(itarget, 0); }
+
+    /**
+     * Sets a target velocity and the acceleration the target is changing at, e.g. from a
+     * motion profile
+     * @param ivel   Target velocity
+     * @param iaccel Target acceleration
+     */
+    void setSetpoint(const float ivel, const float iaccel);
+
+    /**
+     * Sets the target from a motion profile setpoint. The position is not used
+     * @param isetpoint Setpoint
+     */
+    void setSetpoint(const MotionSetpoint& isetpoint) { setSetpoint(isetpoint.velocity, isetpoint.acceleration); }
+
+    float getOutput() const override { return isOn ? output : 0; }
+
+    float getError() const override { return error; }
+
+    /**
+     * Set time between loops in ms
+     * @param isampleTime Time between loops in ms
+     */
+    void setSampleTime(const int isampleTime) override;
+
+    /**
+     * Set controller output bounds. The integral is held within them too
+     * @param imax Max output
+     * @param imin Min output
+     */
+    void setOutputLimits(float imax, float imin) override;
+
+    /**
+     * Clear the output, integral, and velocity. The next step only takes a fresh position for
+     * VelMath and keeps the output at 0, so the velocity does not spike from the position before
+     * the reset. The first step after construction works the same way
+     */
+    void reset() override;
+
+    void flipDisable() override { isOn = !isOn; }
+
+    /**
+     * Set feedback gains
+     * @param ikP Proportional gain
+     * @param ikI Integral gain, per sample time
+     */
+    void setGains(const float ikP, const float ikI);
+
+    void setFeedforward(const VelFeedforward& ifeedforward) { feedforward = ifeedforward; }
+
+    /**
+     * Returns the last velocity in units per second
+     */
+    float getVel() const { return velMath.getOutput() * velScale; }
+  private:
+    VelFeedforward feedforward;
+    float kP, kI;
+    unsigned long lastTime; //PAL::micros at the last iteration
+    long sampleTime; //ms
+    float target, targetAccel, error;
+    float integral;
+    float output, outputMax, outputMin;
+    bool isOn;
+    VelMath velMath;
+    bool hasPosition; //Whether velMath has a position to differentiate from
+    const float velScale; //Units per second per RPM
+
+    /**
+     * Runs the controller math
+     * @param inewReading New position
+     * @param idtRatio    Time step divided by the sample time the gains are scaled for
+     */
+    void update(const float inewReading, const float idtRatio);
+  };
+}
+
+#endif /* end of include guard: OKAPI_FEEDFORWARDVELCONTROLLER */
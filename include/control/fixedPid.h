@@ -0,0 +1,287 @@
+#ifndef OKAPI_FIXEDPID
+#define OKAPI_FIXEDPID
+
+#include <cstdint>
+#include "control/controlObject.h"
+#include "control/pid.h"
+#include "PAL/PAL.h"
+
+namespace okapi {
+  /**
+   * PID controller which does all of its math in fixed point (Q(31 - fracBits).fracBits) so it
+   * never calls into libgcc's soft-float routines. Behaves like Pid: integral limits,
+   * reset-on-cross, derivative on measurement, and output clamping. Use stepInt to go from an
+   * integer sensor reading to a motor power without touching floats at all.
+   */
+  template<unsigned int fracBits = 16>
+  class FixedPid : public ControlObject {
+    static_assert(fracBits >= 1 && fracBits <= 24, "FixedPid needs between 1 and 24 fractional bits");
+
+  public:
+    /**
+     * Fixed point PID controller
+     * @param ikP    Proportional gain
+     * @param ikI    Integral gain
+     * @param ikD    Derivative gain
+     * @param ikBias Controller bias (added to final output)
+     */
+    FixedPid(const float ikP, const float ikI, const float ikD, const float ikBias = 0):
+      lastTime(0),
+      sampleTime(15),
+      error(0),
+      lastError(0),
+      target(0),
+      lastReading(0),
+      integral(0),
+      integralMax(fromInt(127)),
+      integralMin(fromInt(-127)),
+      output(0),
+      outputMax(fromInt(127)),
+      outputMin(fromInt(-127)),
+      shouldResetOnCross(true),
+      isOn(true),
+      isGainLost(false) {
+        setGains(ikP, ikI, ikD, ikBias);
+      }
+
+    /**
+     * Fixed point PID controller
+     * @param params Params (see PidParams docs)
+     */
+    FixedPid(const PidParams& params):
+      FixedPid(params.kP, params.kI, params.kD, params.kBias) {}
+
+    virtual ~FixedPid() = default;
+
+    /**
+     * Do one iteration of the controller
+     * @param  inewReading New measurement
+     * @return             Controller output
+     */
+    float step(const float inewReading) override { return toFloat(stepFixed(fromFloat(inewReading))); }
+
+    /**
+     * Do one iteration of the controller without any float math
+     * @param  inewReading New measurement (e.g. encoder ticks)
+     * @return             Controller output truncated to an integer (e.g. motor power)
+     */
+    int stepInt(const int inewReading) { return toInt(stepFixed(fromInt(inewReading))); }
+
+    /**
+     * Do one iteration of the controller in fixed point
+     * @param  inewReading New measurement in fixed point
+     * @return             Controller output in fixed point
+     */
+    std::int32_t stepFixed(const std::int32_t inewReading) {
+      if (isOn) {
+        const long now = PAL::millis();
+
+        if (now - lastTime >= sampleTime) {
+          update(inewReading, fromInt(1));
+          lastTime = now; //Important that we only assign lastTime if dt >= sampleTime
+        }
+      } else {
+        output = 0; //Controller is off so write 0
+      }
+
+      return output;
+    }
+
+    /**
+     * Do one iteration of the controller with a time step measured by the caller
+     * @param  inewReading New measurement
+     * @param  idt         Time since the last iteration in ms
+     * @return             Controller output
+     */
+    float stepDt(const float inewReading, const float idt) override {
+      if (isOn) {
+        update(fromFloat(inewReading), fromFloat(idt / static_cast<float>(sampleTime)));
+        lastTime = PAL::millis();
+      } else {
+        output = 0; //Controller is off so write 0
+      }
+
+      return toFloat(output);
+    }
+
+    void setTarget(const float itarget) override { target = fromFloat(itarget); }
+
+    /**
+     * Sets the target for the controller without any float math
+     * @param itarget New target (e.g. encoder ticks)
+     */
+    void setTargetInt(const int itarget) { target = fromInt(itarget); }
+
+    float getOutput() const override { return toFloat(output); }
+
+    float getError() const override { return toFloat(error); }
+
+    /**
+     * Set controller gains. kI and kD are scaled by the sample time before they are converted,
+     * so a small kI can come out below one LSB (2^-fracBits) and round to 0; check hasLostGain
+     * afterwards, and use more fractional bits if it is set
+     * @param ikP    Proportional gain
+     * @param ikI    Integral gain
+     * @param ikD    Derivative gain
+     * @param ikBias Controller bias
+     */
+    void setGains(const float ikP, const float ikI, const float ikD, const float ikBias = 0) {
+      const float sampleTimeSec = static_cast<float>(sampleTime) / 1000.0;
+      kPf = ikP;
+      kIf = ikI;
+      kDf = ikD;
+      kP = fromFloat(ikP);
+      kI = fromFloat(ikI * sampleTimeSec);
+      kD = fromFloat(ikD * sampleTimeSec);
+      kBias = fromFloat(ikBias);
+      isGainLost = (ikP != 0 && kP == 0) || (ikI != 0 && kI == 0) || (ikD != 0 && kD == 0) || (ikBias != 0 && kBias == 0);
+    }
+
+    /**
+     * Returns whether a nonzero gain rounded to 0 in fixed point, which silently turns its term off
+     */
+    bool hasLostGain() const { return isGainLost; }
+
+    /**
+     * Set time between loops in ms
+     * @param isampleTime Time between loops in ms
+     */
+    void setSampleTime(const int isampleTime) override {
+      if (isampleTime > 0) {
+        sampleTime = isampleTime;
+        setGains(kPf, kIf, kDf, toFloat(kBias)); //Rescale from the float gains so rounding does not accumulate
+      }
+    }
+
+    /**
+     * Set controller output bounds
+     * @param imax Max output
+     * @param imin Min output
+     */
+    void setOutputLimits(float imax, float imin) override {
+      //Always use larger value as max
+      if (imin > imax) {
+        const float temp = imax;
+        imax = imin;
+        imin = temp;
+      }
+
+      outputMax = fromFloat(imax);
+      outputMin = fromFloat(imin);
+
+      //Fix output
+      if (output > outputMax)
+        output = outputMax;
+      else if (output < outputMin)
+        output = outputMin;
+
+      //Fix integral
+      setIntegralLimits(imax, imin);
+    }
+
+    /**
+     * Set integrator bounds
+     * @param imax Max integrator value
+     * @param imin Min integrator value
+     */
+    void setIntegralLimits(float imax, float imin) {
+      //Always use larger value as max
+      if (imin > imax) {
+        const float temp = imax;
+        imax = imin;
+        imin = temp;
+      }
+
+      integralMax = fromFloat(imax);
+      integralMin = fromFloat(imin);
+
+      //Fix integral
+      if (integral > integralMax)
+        integral = integralMax;
+      else if (integral < integralMin)
+        integral = integralMin;
+    }
+
+    /**
+     * Resets the controller so it can start from 0 again properly. Keeps gains
+     * and limits from before
+     */
+    void reset() override {
+      error = 0;
+      lastError = 0;
+      lastReading = 0;
+      integral = 0;
+      output = 0;
+    }
+
+    /**
+     * Set whether the integrator should be reset when error is 0 or changes sign
+     * @param iresetOnZero True to reset
+     */
+    void setIntegratorReset(bool iresetOnZero) { shouldResetOnCross = iresetOnZero; }
+
+    void flipDisable() override { isOn = !isOn; }
+
+    static constexpr std::int32_t fromInt(const int ival) { return saturate(static_cast<std::int64_t>(ival) * (1 << fracBits)); }
+    static constexpr int toInt(const std::int32_t ival) { return static_cast<int>(ival >> fracBits); }
+    static std::int32_t fromFloat(const float ival) { return saturate(static_cast<std::int64_t>(ival * static_cast<float>(1 << fracBits) + (ival < 0 ? -0.5f : 0.5f))); } //Round to nearest
+    static float toFloat(const std::int32_t ival) { return static_cast<float>(ival) / static_cast<float>(1 << fracBits); }
+  protected:
+    std::int32_t kP, kI, kD, kBias;
+    float kPf, kIf, kDf; //Unscaled gains, kept so a new sample time can rescale kI and kD exactly
+    long lastTime, sampleTime;
+    std::int32_t error, lastError;
+    std::int32_t target, lastReading;
+    std::int32_t integral, integralMax, integralMin;
+    std::int32_t output, outputMax, outputMin;
+    bool shouldResetOnCross, isOn;
+    bool isGainLost; //A nonzero gain rounded to 0
+
+    /**
+     * Runs the PID math
+     * @param inewReading New measurement in fixed point
+     * @param idtRatio    Time step divided by the sample time the gains are scaled for, in fixed point
+     */
+    void update(const std::int32_t inewReading, const std::int32_t idtRatio) {
+      error = saturate(static_cast<std::int64_t>(target) - inewReading);
+
+      integral = saturate(static_cast<std::int64_t>(integral) + mul(mul(kI, error), idtRatio)); //Eliminate integral kick while realtime tuning
+
+      if (shouldResetOnCross && (error < 0) != (lastError < 0))
+        integral = 0;
+
+      if (integral > integralMax)
+        integral = integralMax;
+      else if (integral < integralMin)
+        integral = integralMin;
+
+      //Derivative over measurement to eliminate derivative kick on setpoint change
+      std::int32_t derivative = saturate(static_cast<std::int64_t>(inewReading) - lastReading);
+      if (idtRatio != fromInt(1))
+        derivative = idtRatio > 0 ? saturate((static_cast<std::int64_t>(derivative) << fracBits) / idtRatio) : 0;
+
+      const std::int64_t out = static_cast<std::int64_t>(mul(kP, error)) + integral - mul(kD, derivative) + kBias;
+
+      if (out > outputMax)
+        output = outputMax;
+      else if (out < outputMin)
+        output = outputMin;
+      else
+        output = static_cast<std::int32_t>(out);
+
+      lastReading = inewReading;
+      lastError = error;
+    }
+
+    //One 32x32->64 multiply and a shift, which the Cortex-M3 does in hardware
+    static std::int32_t mul(const std::int32_t a, const std::int32_t b) {
+      return saturate((static_cast<std::int64_t>(a) * b) >> fracBits);
+    }
+
+    static constexpr std::int32_t saturate(const std::int64_t ival) {
+      return ival > INT32_MAX ? INT32_MAX : (ival < INT32_MIN ? INT32_MIN : static_cast<std::int32_t>(ival));
+    }
+  };
+}
+
+#endif /* end of include guard: OKAPI_FIXEDPID */
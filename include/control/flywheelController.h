@@ -0,0 +1,216 @@
+#ifndef OKAPI_FLYWHEELCONTROLLER
+#define OKAPI_FLYWHEELCONTROLLER
+
+#include "control/controlObject.h"
+#include "control/velMath.h"
+
+namespace okapi {
+  /**
+   * Base for flywheel velocity controllers. Readings are positions (e.g. encoder ticks) which
+   * VelMath turns into RPM, and the target is in RPM, as with VelPid.
+   *
+   * Launching a ball pulls the flywheel below its target. A drop of more than the shot threshold
+   * within a short time of being at speed counts as a shot (a slow sag does not), and the output is pinned at full
+   * power until the flywheel is back within the recovery band, instead of waiting for the
+   * controller to wind itself back up. The derived controller then picks up from where it was
+   * before the shot.
+   */
+  class FlywheelController : public ControlObject {
+  public:
+    /**
+     * Flywheel controller
+     * @param ivelParams Velocity math params
+     */
+    explicit FlywheelController(const VelMathParams& ivelParams);
+
+    virtual ~FlywheelController() = default;
+
+    /**
+     * Do one iteration of the controller if a sample time has passed since the last one
+     * @param  inewReading New position
+     * @return             Controller output
+     */
+    float step(const float inewReading) override;
+
+    /**
+     * Do one iteration of the controller with a time step measured by the caller
+     * @param  inewReading New position
+     * @param  idt         Time since the last iteration in ms
+     * @return             Controller output
+     */
+    float stepDt(const float inewReading, const float idt) override;
+
+    /**
+     * Sets the target velocity in RPM. The flywheel has to get to speed again before the next
+     * shot is detected
+     * @param itarget Target in RPM
+     */
+    void setTarget(const float itarget) override;
+
+    float getOutput() const override { return isOn ? output : 0; }
+
+    float getError() const override { return error; }
+
+    /**
+     * Set time between loops in ms
+     * @param isampleTime Time between loops in ms
+     */
+    void setSampleTime(const int isampleTime) override;
+
+    /**
+     * Set controller output bounds. The recovery boost uses the bound in the direction of the target
+     * @param imax Max output
+     * @param imin Min output
+     */
+    void setOutputLimits(float imax, float imin) override;
+
+    /**
+     * Clear the output, shot detection, and velocity. The next step only takes a fresh position
+     * for VelMath and keeps the output at 0, so the velocity does not spike from the position
+     * before the reset. The first step after construction works the same way
+     */
+    void reset() override;
+
+    void flipDisable() override { isOn = !isOn; }
+
+    /**
+     * Set the shot detection thresholds, each as a fraction of the target
+     * @param ireadyBand     Error within which the flywheel is at speed and a shot can be detected
+     * @param ishotDrop      Drop below the target which counts as a shot (0 to turn detection off)
+     * @param irecoveredBand Error within which the recovery boost ends
+     * @param ishotTime      Longest a drop may take from leaving the ready band, in ms
+     */
+    void setShotDetection(const float ireadyBand, const float ishotDrop, const float irecoveredBand, const unsigned long ishotTime = 60);
+
+    /**
+     * Returns whether the flywheel is at speed and ready to shoot
+     */
+    bool isReady() const;
+
+    /**
+     * Returns whether the recovery boost after a shot is running
+     */
+    bool isRecovering() const { return recovering; }
+
+    /**
+     * Returns the number of shots detected since the last reset
+     */
+    unsigned long getShotCount() const { return shotCount; }
+
+    /**
+     * Returns the last velocity in RPM
+     */
+    float getVel() const { return velMath.getOutput(); }
+  protected:
+    float target, error, output, outputMax, outputMin;
+    long sampleTime; //ms
+
+    /**
+     * Computes a new output. The result is clamped to the output limits afterwards
+     * @param  ivel     Velocity in RPM
+     * @param  idtRatio Time step divided by the sample time the gains are scaled for
+     * @return          New output
+     */
+    virtual float compute(const float ivel, const float idtRatio) = 0;
+
+    /**
+     * Called when the recovery boost ends, before the next compute
+     */
+    virtual void onRecovered() {}
+  private:
+    unsigned long lastTime; //PAL::micros at the last iteration
+    bool isOn;
+    VelMath velMath;
+    float readyBand, shotDrop, recoveredBand;
+    unsigned long shotTime; //us
+    unsigned long lastReadyTime; //PAL::micros when the flywheel was last at speed
+    bool isArmed, recovering;
+    unsigned long shotCount;
+    bool hasPosition; //Whether velMath has a position to differentiate from
+
+    /**
+     * Runs shot detection and the controller
+     * @param inewReading New position
+     * @param idtRatio    Time step divided by the sample time the gains are scaled for
+     */
+    void update(const float inewReading, const float idtRatio);
+  };
+
+  class TbhController : public FlywheelController {
+  public:
+    /**
+     * Take-back-half controller. Integrates the error into the output, and each time the
+     * velocity crosses the target, sets the output halfway between its current value and its
+     * value at the last crossing, which homes in on the power that holds the target
+     * @param igain      Output change per RPM of error per sample time
+     * @param iestimate  Output expected to hold the target, jumped to at the first crossing
+     *                   instead of halving toward 0 (0 to halve)
+     * @param ivelParams Velocity math params
+     */
+    explicit TbhController(const float igain, const float iestimate = 0, const VelMathParams& ivelParams = VelMathParams(360));
+
+    /**
+     * Sets the target velocity in RPM. The next crossing counts as the first one again
+     * @param itarget Target in RPM
+     */
+    void setTarget(const float itarget) override;
+
+    void reset() override;
+
+    void setGain(const float igain) { gain = igain; }
+
+    /**
+     * Set the output expected to hold the target
+     * @param iestimate Output jumped to at the first crossing (0 to halve)
+     */
+    void setEstimate(const float iestimate) { estimate = iestimate; }
+  protected:
+    float compute(const float ivel, const float idtRatio) override;
+
+    void onRecovered() override;
+  private:
+    float gain, estimate;
+    float tbh; //Output at the last crossing
+    float lastError;
+    bool hasCrossed;
+  };
+
+  class BangBangController : public FlywheelController {
+  public:
+    /**
+     * Bang-bang controller with hysteresis. Drives at the high power below the band around the
+     * target, at the low power above it, and keeps the last power inside it so the motors do
+     * not chatter
+     * @param ilowBand   RPM below the target at which to switch to the high power
+     * @param ihighBand  RPM above the target at which to switch to the low power
+     * @param ihighPower Power below the band (the output limit in the direction of the target if 0)
+     * @param ilowPower  Power above the band
+     * @param ivelParams Velocity math params
+     */
+    BangBangController(const float ilowBand, const float ihighBand, const float ihighPower = 0, const float ilowPower = 0, const VelMathParams& ivelParams = VelMathParams(360));
+  protected:
+    float compute(const float ivel, const float idtRatio) override;
+  private:
+    float lowBand, highBand, highPower, lowPower;
+  };
+
+  class FeedforwardFlywheelController : public FlywheelController {
+  public:
+    /**
+     * Feedforward plus proportional controller. The feedforward term holds the target on its
+     * own and the proportional term corrects what it misses
+     * @param ikF        Output per RPM of target
+     * @param ikP        Output per RPM of error
+     * @param ivelParams Velocity math params
+     */
+    FeedforwardFlywheelController(const float ikF, const float ikP, const VelMathParams& ivelParams = VelMathParams(360));
+
+    void setGains(const float ikF, const float ikP);
+  protected:
+    float compute(const float ivel, const float idtRatio) override;
+  private:
+    float kF, kP;
+  };
+}
+
+#endif /* end of include guard: OKAPI_FLYWHEELCONTROLLER */
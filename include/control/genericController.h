@@ -20,9 +20,15 @@ namespace okapi {
         motors[i].setTS(static_cast<int>(controller->getOutput()));
     }
 
+    void stepDt(const float ireading, const float idt) {
+      controller->stepDt(ireading, idt);
+      for (size_t i = 0; i < motors.size(); i++)
+        motors[i].setTS(static_cast<int>(controller->getOutput()));
+    }
+
     void setTarget(const float itarget) { controller->setTarget(itarget); }
 
-    void getOutput() const { return controller->getOutput(); }
+    float getOutput() const { return controller->getOutput(); }
 
     void setSampleTime(const int isampleTime) { controller->setSampleTime(isampleTime); }
 
@@ -0,0 +1,103 @@
+#ifndef OKAPI_MOTIONPROFILE
+#define OKAPI_MOTIONPROFILE
+
+#include <array>
+#include <cstddef>
+
+namespace okapi {
+  class MotionProfileParams {
+  public:
+    /**
+     * Limits for a motion profile. Distance units are whatever the profile is followed in (e.g.
+     * encoder ticks)
+     * @param imaxVel   Max velocity in units per second
+     * @param imaxAccel Max acceleration in units per second squared
+     * @param imaxJerk  Max jerk in units per second cubed, or 0 for a trapezoidal profile
+     */
+    MotionProfileParams(const float imaxVel, const float imaxAccel, const float imaxJerk = 0):
+      maxVel(imaxVel),
+      maxAccel(imaxAccel),
+      maxJerk(imaxJerk) {}
+
+    float maxVel, maxAccel, maxJerk;
+  };
+
+  class MotionSetpoint {
+  public:
+    MotionSetpoint(const float iposition, const float ivelocity, const float iacceleration):
+      position(iposition),
+      velocity(ivelocity),
+      acceleration(iacceleration) {}
+
+    MotionSetpoint():
+      position(0),
+      velocity(0),
+      acceleration(0) {}
+
+    float position, velocity, acceleration;
+  };
+
+  class MotionProfile {
+  public:
+    /**
+     * Time optimal point to point profile under velocity, acceleration, and (optionally) jerk
+     * limits. generate() solves for the profile once and stores it as a table of at most seven
+     * constant jerk segments, so get() only has to evaluate one polynomial
+     * @param iparams Profile limits
+     */
+    MotionProfile(const MotionProfileParams& iparams);
+
+    /**
+     * Sets the profile limits. Takes effect on the next call to generate()
+     * @param iparams Profile limits
+     */
+    void setParams(const MotionProfileParams& iparams) { params = iparams; }
+
+    /**
+     * Solves for a profile from rest at 0 to rest at a distance
+     * @param idistance Distance to travel (may be negative)
+     */
+    void generate(const float idistance);
+
+    /**
+     * Returns the setpoint at a time since the start of the profile. Times past the end return
+     * the final position at rest
+     * @param  itime Time since the start of the profile in seconds
+     * @return       Setpoint
+     */
+    MotionSetpoint get(const float itime) const;
+
+    /**
+     * Returns the length of the profile
+     * @return Length of the profile in seconds
+     */
+    float getDuration() const { return duration; }
+  private:
+    class Segment {
+    public:
+      Segment():
+        time(0),
+        jerk(0) {}
+
+      float time; //Start time
+      MotionSetpoint start;
+      float jerk;
+    };
+
+    static constexpr std::size_t maxSegments = 7;
+
+    MotionProfileParams params;
+    std::array<Segment, maxSegments> segments;
+    float distance, duration, sign;
+
+    /**
+     * Returns the time spent getting from rest to a velocity
+     * @param  ivel      Velocity
+     * @param  ojerkTime Time spent at max jerk on each end of the ramp
+     * @return           Time spent accelerating
+     */
+    float rampTime(const float ivel, float& ojerkTime) const;
+  };
+}
+
+#endif /* end of include guard: OKAPI_MOTIONPROFILE */
@@ -19,6 +19,14 @@ namespace okapi {
        * @return            Controller output
        */
       virtual float step(const float inewReading) override;
+
+      /**
+       * Do one iteration of the controller with a time step measured by the caller
+       * @param  inewReading New measurement
+       * @param  idt         Time since the last iteration in ms
+       * @return             Controller output
+       */
+      virtual float stepDt(const float inewReading, const float idt) override;
     protected:
       VelMath velMath;
       float minVel, scale;
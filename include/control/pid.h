@@ -67,11 +67,20 @@ namespace okapi {
     virtual ~Pid() = default;
 
     /**
-     * Do one iteration of the controller
+     * Do one iteration of the controller if a sample time has passed since the last one. The
+     * time step is measured in microseconds, and the math is scaled by how long it really was
      * @param  inewReading New measurement
      * @return            Controller output
      */
     virtual float step(const float inewReading) override;
+
+    /**
+     * Do one iteration of the controller with a time step measured by the caller
+     * @param  inewReading New measurement
+     * @param  idt         Time since the last iteration in ms
+     * @return             Controller output
+     */
+    virtual float stepDt(const float inewReading, const float idt) override;
     
     void setTarget(const float itarget) override { target = itarget; }
 
@@ -123,12 +132,20 @@ namespace okapi {
     void flipDisable() override { isOn = !isOn; }
   protected:
     float kP, kI, kD, kBias;
-    long lastTime, sampleTime;
+    unsigned long lastTime; //PAL::micros at the last iteration
+    long sampleTime; //ms
     float error, lastError;
     float target, lastReading;
     float integral, integralMax, integralMin;
     float output, outputMax, outputMin;
     bool shouldResetOnCross, isOn;
+
+    /**
+     * Runs the PID math
+     * @param inewReading New measurement
+     * @param idtRatio    Time step divided by the sample time the gains are scaled for
+     */
+    void update(const float inewReading, const float idtRatio);
   };
 }
 
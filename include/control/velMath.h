@@ -1,28 +1,48 @@
 #ifndef OKAPI_VELOCITY
 #define OKAPI_VELOCITY
 
+#include <array>
+#include <cstddef>
 #include "filter/demaFilter.h"
 
 namespace okapi {
   class VelMathParams {
     public:
-      VelMathParams(const float iticksPerRev, const float ialpha = 0.19, const float ibeta = 0.041):
+      /**
+       * Velocity math params
+       * @param iticksPerRev Encoder ticks per revolution
+       * @param ialpha       DemaFilter alpha gain
+       * @param ibeta        DemaFilter beta gain
+       * @param iminTicks    Ticks the adaptive window has to span (0 to difference one step at a time and filter)
+       * @param imaxWindow   Longest the adaptive window may grow in ms
+       */
+      VelMathParams(const float iticksPerRev, const float ialpha = 0.19, const float ibeta = 0.041, const float iminTicks = 0, const unsigned long imaxWindow = 100):
         ticksPerRev(iticksPerRev),
         alpha(ialpha),
-        beta(ibeta) {}
+        beta(ibeta),
+        minTicks(iminTicks),
+        maxWindow(imaxWindow) {}
 
-      float ticksPerRev, alpha, beta;
+      float ticksPerRev, alpha, beta, minTicks;
+      unsigned long maxWindow;
   };
 
   class VelMath {
   public:
+    static constexpr std::size_t windowSize = 32;
+
     VelMath(const float iticksPerRev, const float ialpha = 0.19, const float ibeta = 0.041):
       lastTime(0),
       vel(0),
       lastVel(0),
       lastPos(0),
       ticksPerRev(iticksPerRev),
-      filter(ialpha, ibeta) {}
+      minTicks(0),
+      maxWindow(0),
+      filter(ialpha, ibeta),
+      samples(),
+      sampleCount(0),
+      isRestarted(false) {}
 
     VelMath(const VelMathParams& iparams):
       lastTime(0),
@@ -30,26 +50,68 @@ namespace okapi {
       lastVel(0),
       lastPos(0),
       ticksPerRev(iparams.ticksPerRev),
-      filter(iparams.alpha, iparams.beta) {}
+      minTicks(iparams.minTicks),
+      maxWindow(iparams.maxWindow * 1000),
+      filter(iparams.alpha, iparams.beta),
+      samples(),
+      sampleCount(0),
+      isRestarted(false) {}
 
     /**
-     * Calculate new velocity
+     * Calculate new velocity from the time since the last call, measured in microseconds. A
+     * second call within the same microsecond returns the last velocity unchanged.
+     *
+     * With a minimum tick count set (see VelMathParams), the velocity is instead the slope over
+     * the shortest run of recent calls spanning that many ticks (or the max window, at low speed),
+     * which is quiet at low speed without lagging at high speed, so the filter is not used
      * @param  inewPos New position
-     * @return         New velocity
+     * @return         New velocity in RPM
      */
     float step(const float inewPos);
 
+    /**
+     * Forget the velocity and start over from a position, so the next step only differentiates
+     * from here, and the filter starts at that step's velocity instead of ramping up from 0. Use
+     * this when the readings restart or jump (e.g. the encoder was reset)
+     * @param ipos Current position
+     */
+    void reset(const float ipos);
+
     void setGains(const float ialpha, const float ibeta) { filter.setGains(ialpha, ibeta); }
 
     void setTicksPerRev(const float iTPR) { ticksPerRev = iTPR; }
 
+    /**
+     * Set the adaptive window limits
+     * @param iminTicks  Ticks the window has to span (0 to difference one step at a time and filter)
+     * @param imaxWindow Longest the window may grow in ms
+     */
+    void setWindow(const float iminTicks, const unsigned long imaxWindow);
+
     float getOutput() const { return vel; }
 
     float getDiff() const { return vel - lastVel; }
   private:
-    long lastTime;
+    class Sample {
+    public:
+      unsigned long time; //PAL::micros
+      float pos;
+    };
+
+    unsigned long lastTime; //PAL::micros at the last step
     float vel, lastVel, lastPos, ticksPerRev;
+    float minTicks;
+    unsigned long maxWindow; //us
     DemaFilter filter;
+    std::array<Sample, windowSize> samples; //Ring of recent steps for the adaptive window
+    std::size_t sampleCount;
+    bool isRestarted; //Whether the next velocity starts the filter over, after reset()
+
+    /**
+     * Finds the slope over the adaptive window ending at the newest sample
+     * @return Velocity in ticks per us
+     */
+    float windowSlope() const;
   };
 }
 
@@ -53,6 +53,25 @@ namespace okapi {
         setGains(params.kP, params.kD);
       }
 
+    /**
+     * Velocity PID controller
+     * @param params     Params (see VelPidParams docs)
+     * @param ivelParams Velocity math params, e.g. to use an adaptive window (see VelMathParams docs)
+     */
+    VelPid(const VelPidParams& params, const VelMathParams& ivelParams):
+      lastTime(0),
+      sampleTime(15),
+      error(0),
+      lastError(0),
+      target(0),
+      output(0),
+      outputMax(127),
+      outputMin(-127),
+      isOn(true),
+      velMath(ivelParams) {
+        setGains(params.kP, params.kD);
+      }
+
     virtual ~VelPid() = default;
 
     /**
@@ -63,12 +82,21 @@ namespace okapi {
     virtual float stepVel(const float inewReading);
 
     /**
-     * Do one iteration of the controller
+     * Do one iteration of the controller if a sample time has passed since the last one. The
+     * time step is measured in microseconds, and the math is scaled by how long it really was
      * @param  inewReading New measurement
      * @return            Controller output
      */
     virtual float step(const float inewReading) override;
 
+    /**
+     * Do one iteration of the controller with a time step measured by the caller
+     * @param  inewReading New measurement
+     * @param  idt         Time since the last iteration in ms
+     * @return             Controller output
+     */
+    virtual float stepDt(const float inewReading, const float idt) override;
+
     void setTarget(const float itarget) override { target = itarget; }
     
     float getOutput() const override { return isOn ? output : 0; }
@@ -113,16 +141,31 @@ namespace okapi {
      */
     void setTicksPerRev(const float tpr) { velMath.setTicksPerRev(tpr); }
 
+    /**
+     * Set the adaptive velocity window (see VelMath::setWindow). Off (0 ticks) by default
+     * @param iminTicks  Ticks the window has to span
+     * @param imaxWindow Longest the window may grow in ms
+     */
+    void setVelWindow(const float iminTicks, const unsigned long imaxWindow) { velMath.setWindow(iminTicks, imaxWindow); }
+
     float getVel() const { return velMath.getOutput(); }
 
   private:
     float kP, kD;
-    long lastTime, sampleTime;
+    unsigned long lastTime; //PAL::micros at the last iteration
+    long sampleTime; //ms
     float error, lastError;
     float target;
     float output, outputMax, outputMin;
     bool isOn;
     VelMath velMath;
+
+    /**
+     * Runs the PID math
+     * @param inewReading New measurement
+     * @param idtRatio    Time step divided by the sample time the gains are scaled for
+     */
+    void update(const float inewReading, const float idtRatio);
   };
 }
 
@@ -0,0 +1,94 @@
+#ifndef OKAPI_EDGEENCODER
+#define OKAPI_EDGEENCODER
+
+#include <atomic>
+#include <cstddef>
+#include "device/rotarySensor.h"
+#include "util/historyBuffer.h"
+#include "PAL/PAL.h"
+
+namespace okapi {
+  class EncoderEdge {
+  public:
+    unsigned long time; //PAL::micros when the edge was seen
+    int count; //Tick count right after the edge
+  };
+
+  class EdgeEncoder : public RotarySensor {
+  public:
+    static constexpr std::size_t historySize = 64;
+    static constexpr std::size_t maxEdges = 16; //Most edges one velocity is taken over
+    static constexpr std::size_t maxAccelEdges = 28; //Most edges each velocity in an acceleration is taken over
+
+    /**
+     * Quadrature encoder decoded in interrupt handlers on its two ports instead of by
+     * PAL::encoderInit, so that every edge is timestamped as it happens. Velocity and acceleration
+     * come from the time between real edges, so they are exact to the microsecond at any speed
+     * and do not depend on how often they are read. Counts 360 ticks per revolution, the same
+     * as QuadEncoder. Do not use PAL::encoderInit on the same ports
+     * @param iportTop    Top digital port (any but 10, which has no interrupt)
+     * @param iportBottom Bottom digital port (any but 10)
+     * @param ireversed   Whether the encoder is reversed
+     * @param imaxWindow  Oldest edge a velocity may use in ms; bounds the lag at low speed
+     */
+    EdgeEncoder(const unsigned char iportTop, const unsigned char iportBottom, const bool ireversed = false, const unsigned long imaxWindow = 100);
+
+    ~EdgeEncoder();
+
+    EdgeEncoder(const EdgeEncoder&) = delete;
+    EdgeEncoder& operator=(const EdgeEncoder&) = delete;
+
+    int get() override { return count.load(std::memory_order_relaxed) - offset; }
+    void reset() override { offset = count.load(std::memory_order_relaxed); }
+
+    /**
+     * Returns the velocity from the most recent edges, over whole quadrature cycles where
+     * possible so uneven spacing between the two channels cancels out. Once the encoder has gone
+     * quiet for longer than the edges were apart, the velocity decays as if the next edge were
+     * just about to arrive, so it reaches zero when the encoder stops
+     * @return Velocity in RPM
+     */
+    float getVelocity() const;
+
+    /**
+     * Returns the acceleration from the velocities over the two most recent runs of edges. The
+     * runs are longer than for getVelocity, since differencing two velocities amplifies noise
+     * @return Acceleration in RPM per second
+     */
+    float getAcceleration() const;
+
+    /**
+     * Returns the number of edges which were not a valid quadrature step (both channels changed
+     * at once, so an edge was missed)
+     */
+    unsigned long getErrorCount() const { return errors.load(std::memory_order_relaxed); }
+
+    static void handleInterrupt(unsigned char ipin);
+  private:
+    const unsigned char portTop, portBottom;
+    const bool reversed;
+    const unsigned long maxWindow; //us
+    std::atomic<int> count;
+    int offset; //Count at the last reset
+    unsigned char state; //Top level in bit 1, bottom level in bit 0
+    std::atomic<unsigned long> errors;
+    HistoryBuffer<EncoderEdge, historySize> edges;
+
+    /**
+     * Decodes one edge. Runs in the interrupt handler
+     */
+    void onEdge();
+
+    /**
+     * Picks how many edges back to take a velocity over
+     * @param  istart    Age of the newest edge to use
+     * @param  ofirst    Newest edge
+     * @param  olast     Oldest edge
+     * @param  imaxEdges Most edges to use
+     * @return           Number of edges between them, or 0 if there are not two edges to use
+     */
+    std::size_t findSpan(std::size_t istart, EncoderEdge& ofirst, EncoderEdge& olast, std::size_t imaxEdges) const;
+  };
+}
+
+#endif /* end of include guard: OKAPI_EDGEENCODER */
@@ -0,0 +1,34 @@
+#ifndef OKAPI_GYROSCOPE
+#define OKAPI_GYROSCOPE
+
+#include "PAL/PAL.h"
+#include "device/rotarySensor.h"
+
+namespace okapi {
+  class Gyroscope : public RotarySensor {
+  public:
+    /**
+     * Yaw rate gyro on an analog port. The gyro calibrates when this is constructed, so the robot
+     * must be still (construct it in initialize())
+     * @param iport       Analog port (1-8)
+     * @param imultiplier Calibration multiplier, or 0 for the default
+     * @param ireversed   Whether to count clockwise rotation as positive instead of
+     *                    counterclockwise
+     */
+    Gyroscope(const unsigned char iport, const unsigned short imultiplier = 0, const bool ireversed = false):
+      gyro(PAL::gyroInit(iport, imultiplier)),
+      reversed(ireversed) {}
+
+    /**
+     * Returns the heading in degrees since the last reset
+     */
+    int get() override { return reversed ? -PAL::gyroGet(gyro) : PAL::gyroGet(gyro); }
+
+    void reset() override { PAL::gyroReset(gyro); }
+  private:
+    const ::Gyro gyro;
+    const bool reversed;
+  };
+}
+
+#endif /* end of include guard: OKAPI_GYROSCOPE */
@@ -8,7 +8,7 @@ namespace okapi {
   class QuadEncoder : public RotarySensor {
   public:
     QuadEncoder(const unsigned char iportTop, const unsigned char iportBottom, const bool ireversed = false):
-      enc(encoderInit(iportTop, iportBottom, ireversed)) {}
+      enc(PAL::encoderInit(iportTop, iportBottom, ireversed)) {}
 
     int get() override { return PAL::encoderGet(enc); }
     void reset() override { PAL::encoderReset(enc); }
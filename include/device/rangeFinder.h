@@ -8,7 +8,7 @@ namespace okapi {
   class RangeFinder {
   public:
     RangeFinder(const unsigned char iportTop, const unsigned char iportBottom):
-      ultra(ultrasonicInit(iportTop, iportBottom)),
+      ultra(PAL::ultrasonicInit(iportTop, iportBottom)),
       vals{0},
       index(0) {}
 
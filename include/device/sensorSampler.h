@@ -0,0 +1,133 @@
+#ifndef OKAPI_SENSORSAMPLER
+#define OKAPI_SENSORSAMPLER
+
+#include <array>
+#include <memory>
+#include "device/rangeFinder.h"
+#include "device/rotarySensor.h"
+#include "util/doubleBuffer.h"
+#include "PAL/PAL.h"
+
+namespace okapi {
+  class SensorSnapshot {
+  public:
+    static constexpr std::size_t maxRotarySensors = 8;
+    static constexpr std::size_t analogChannels = 8;
+    static constexpr std::size_t maxRangeFinders = 4;
+
+    SensorSnapshot():
+      timestamp(0),
+      rotary{},
+      analog{},
+      range{} {}
+
+    unsigned long timestamp; //PAL::micros when the sample started
+    std::array<int, maxRotarySensors> rotary;
+    std::array<int, analogChannels> analog; //Index 0 is channel 1
+    std::array<int, maxRangeFinders> range;
+  };
+
+  class SensorSampler {
+  public:
+    /**
+     * Reads every registered sensor once per period and publishes the values together, so every
+     * consumer sees data from the same instant and each sensor costs one bus transaction per
+     * period no matter how many consumers read it. Register sensors, then call start()
+     * @param iperiod Sample period in ms
+     */
+    explicit SensorSampler(const unsigned long iperiod = 15):
+      period(iperiod),
+      rotaryCount(0),
+      rangeCount(0),
+      analogMask(0),
+      isStarted(false),
+      sampleMutex(nullptr) {}
+
+    /**
+     * Registers a rotary sensor. Must be called before start()
+     * @param  isensor Sensor to sample
+     * @return         Index of the sensor in SensorSnapshot::rotary, or -1 if there is no room
+     */
+    int addRotarySensor(const std::shared_ptr<RotarySensor>& isensor);
+
+    /**
+     * Registers an analog channel. Must be called before start()
+     * @param  ichannel Channel to sample (1-8)
+     * @return          Index of the channel in SensorSnapshot::analog, or -1 if it is invalid
+     */
+    int addAnalog(const unsigned char ichannel);
+
+    /**
+     * Registers a range finder. Must be called before start()
+     * @param  isensor Range finder to sample
+     * @return         Index of the range finder in SensorSnapshot::range, or -1 if there is no room
+     */
+    int addRangeFinder(const std::shared_ptr<RangeFinder>& isensor);
+
+    /**
+     * Reads every registered sensor once and publishes the result
+     */
+    void sample();
+
+    /**
+     * Sample in an infinite loop
+     */
+    void loop();
+
+    static void trampoline(void *context) { static_cast<SensorSampler*>(context)->loop(); }
+
+    /**
+     * Takes the first sample and spins up a sampling task at the default priority plus 2, so
+     * samples are fresh before the odometry task (default priority plus 1) runs
+     */
+    void start();
+
+    /**
+     * Returns the most recent snapshot. Never blocks
+     * @return Most recent snapshot
+     */
+    SensorSnapshot getSnapshot() const { return snapshot.read(); }
+
+    /**
+     * Returns one rotary sensor's value from the most recent snapshot
+     * @param  iindex Index returned by addRotarySensor
+     * @return        Sensor value
+     */
+    int getRotary(const int iindex) const { return getSnapshot().rotary[static_cast<std::size_t>(iindex)]; }
+
+    /**
+     * Resets a registered rotary sensor and publishes a fresh snapshot straight away, so a read
+     * right after the reset does not see the old count
+     * @param iindex Index returned by addRotarySensor
+     */
+    void resetRotary(const int iindex);
+  private:
+    const unsigned long period;
+    std::array<std::shared_ptr<RotarySensor>, SensorSnapshot::maxRotarySensors> rotarySensors;
+    std::array<std::shared_ptr<RangeFinder>, SensorSnapshot::maxRangeFinders> rangeFinders;
+    std::size_t rotaryCount, rangeCount;
+    unsigned int analogMask;
+    bool isStarted;
+    DoubleBuffer<SensorSnapshot> snapshot;
+    Mutex sampleMutex; //Keeps resetRotary and the sampling task from both writing the snapshot
+  };
+
+  /**
+   * A RotarySensor which reads from a SensorSampler's snapshot instead of the hardware. Hand these
+   * to a ChassisModel so odometry and the chassis controller share one coherent sample per tick
+   */
+  class SampledRotarySensor : public RotarySensor {
+  public:
+    SampledRotarySensor(SensorSampler& isampler, const int iindex):
+      sampler(isampler),
+      index(iindex) {}
+
+    int get() override { return sampler.getRotary(index); }
+    void reset() override { sampler.resetRotary(index); }
+  private:
+    SensorSampler& sampler;
+    const int index;
+  };
+}
+
+#endif /* end of include guard: OKAPI_SENSORSAMPLER */
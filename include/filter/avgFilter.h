@@ -14,7 +14,7 @@ namespace okapi {
       index(0),
       output(0) {}
 
-    virtual ~AvgFilter() { delete &data; }
+    virtual ~AvgFilter() = default;
 
     float filter(const float ireading) override {
       data[index++] = ireading;
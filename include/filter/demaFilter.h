@@ -29,6 +29,17 @@ namespace okapi {
       beta = ibeta;
     }
 
+    /**
+     * Starts the filter over at a value with no trend
+     * @param ivalue Value to start at
+     */
+    void reset(const float ivalue = 0) {
+      outputS = ivalue;
+      lastOutputS = ivalue;
+      outputB = 0;
+      lastOutputB = 0;
+    }
+
     float getOutput() const override { return outputS + outputB; }
   private:
     float alpha, beta;
@@ -0,0 +1,61 @@
+#ifndef OKAPI_FIELDMAP
+#define OKAPI_FIELDMAP
+
+#include <cstddef>
+#include "odometry/poseEstimator.h"
+
+namespace okapi {
+  class RaycastHit {
+  public:
+    RaycastHit():
+      range(0),
+      wall(0),
+      incidence(0) {}
+
+    float range; //mm along the ray
+    std::size_t wall; //Index of the wall hit
+    float incidence; //Cosine of the angle between the ray and the wall's normal (0 to 1)
+  };
+
+  class FieldMap {
+  public:
+    /**
+     * A static map of the walls on the field. The walls are not copied, so keep them in a
+     * static (ideally constexpr) array:
+     *   static constexpr FieldSegment walls[] = {{0, 0, 3658, 0}, {3658, 0, 3658, 3658}, ...};
+     *   static constexpr FieldMap map(walls);
+     * @param iwalls Walls
+     */
+    template<std::size_t n>
+    constexpr FieldMap(const FieldSegment (&iwalls)[n]):
+      walls(iwalls),
+      count(n) {}
+
+    /**
+     * Finds the nearest wall along a ray
+     * @param  ix     X coordinate of the ray's start
+     * @param  iy     Y coordinate of the ray's start
+     * @param  itheta Direction of the ray in radians, counterclockwise from the x axis
+     * @param  ohit   Where the ray hit
+     * @return        False if the ray hits no wall
+     */
+    bool raycast(const float ix, const float iy, const float itheta, RaycastHit& ohit) const;
+
+    /**
+     * Returns a wall
+     * @param  iindex Index of the wall
+     * @return        Wall
+     */
+    const FieldSegment& getWall(const std::size_t iindex) const { return walls[iindex]; }
+
+    /**
+     * Returns the number of walls
+     */
+    std::size_t getCount() const { return count; }
+  private:
+    const FieldSegment *walls;
+    std::size_t count;
+  };
+}
+
+#endif /* end of include guard: OKAPI_FIELDMAP */
@@ -0,0 +1,136 @@
+#ifndef OKAPI_ODOMCALIBRATOR
+#define OKAPI_ODOMCALIBRATOR
+
+#include <functional>
+#include <memory>
+#include "chassis/chassisModel.h"
+#include "device/rotarySensor.h"
+#include "odometry/odometry.h"
+
+namespace okapi {
+  class OdomCalibration {
+  public:
+    /**
+     * Measured odometry scales
+     * @param iscale     Scale converting encoder ticks to mm
+     * @param iturnScale Scale converting encoder ticks to degrees
+     * @param imismatch  How much bigger the left wheels are than the right ones, as a fraction
+     */
+    OdomCalibration(const float iscale, const float iturnScale, const float imismatch = 0):
+      scale(iscale),
+      turnScale(iturnScale),
+      mismatch(imismatch) {}
+
+    OdomCalibration():
+      scale(0),
+      turnScale(0),
+      mismatch(0) {}
+
+    /**
+     * Copies the scales into odometry parameters
+     * @param oparams Odometry parameters
+     */
+    void apply(OdomParams& oparams) const;
+
+    /**
+     * Sets an Odometry's scales
+     * @param iodom Odometry
+     */
+    void apply(Odometry& iodom) const;
+
+    /**
+     * Writes the scales to a file in flash so they survive a power cycle
+     * @param  ifile File name (at most 8 characters)
+     * @return       False if the file could not be written
+     */
+    bool save(const char *ifile = "odomcal") const;
+
+    /**
+     * Reads scales written by save(). Leaves the scales alone if the file is missing or corrupt
+     * @param  ifile File name (at most 8 characters)
+     * @return       False if the file is missing or corrupt
+     */
+    bool load(const char *ifile = "odomcal");
+
+    float scale, turnScale, mismatch;
+  };
+
+  class OdomCalibrator {
+  public:
+    /**
+     * Measures a drive's odometry scales by driving it. Run calibrateDistance() first, then
+     * calibrateTurn(), then save the result with getCalibration().save()
+     * @param imodel Chassis model to drive and read encoders from
+     * @param ipower Motor power to drive and turn at
+     */
+    OdomCalibrator(const std::shared_ptr<ChassisModel>& imodel, const int ipower = 40):
+      model(imodel),
+      power(ipower),
+      calibration() {}
+
+    /**
+     * Drives forward until told to stop, then solves for the scale and the wheel diameter
+     * mismatch. Place the robot at a mark and stop it (e.g. with a button) when it reaches a
+     * second mark a known distance away. With a gyro, the robot holds its heading; without one,
+     * it is assumed to have driven straight (guide it along a wall), and any drift is counted as
+     * mismatch
+     * @param  idistance Distance between the marks in mm
+     * @param  iisDone   Returns true once the robot reaches the second mark
+     * @param  igyro     Gyro counting up counterclockwise, or nullptr for none
+     * @param  itimeout  Time to give up after in ms
+     * @return           False if it timed out or the encoders did not move forward
+     */
+    bool calibrateDistance(const float idistance, std::function<bool()> iisDone, const std::shared_ptr<RotarySensor>& igyro = nullptr, const unsigned long itimeout = 15000);
+
+    /**
+     * Spins counterclockwise until told to stop, then solves for the turn scale. Stop it (e.g.
+     * with a button) when it faces its starting direction after some number of turns
+     * @param  iturns   Number of turns the robot will have spun
+     * @param  iisDone  Returns true once the robot has spun iturns turns
+     * @param  itimeout Time to give up after in ms
+     * @return          False if it timed out or the encoders did not turn counterclockwise
+     */
+    bool calibrateTurn(const float iturns, std::function<bool()> iisDone, const unsigned long itimeout = 30000);
+
+    /**
+     * Spins counterclockwise for some number of turns measured by a gyro, lets the robot coast to
+     * a stop, then solves for the turn scale from the gyro's final heading
+     * @param  iturns     Number of turns to spin
+     * @param  igyro      Gyro counting up counterclockwise
+     * @param  igyroScale Degrees per gyro unit
+     * @param  itimeout   Time to give up after in ms, counting the coast
+     * @return            False if it timed out (including if the robot never came to rest) or the
+     *                    encoders did not turn counterclockwise
+     */
+    bool calibrateTurn(const float iturns, const std::shared_ptr<RotarySensor>& igyro, const float igyroScale = 1, const unsigned long itimeout = 30000);
+
+    /**
+     * Returns the scales measured so far
+     * @return Calibration
+     */
+    OdomCalibration getCalibration() const { return calibration; }
+  private:
+    std::shared_ptr<ChassisModel> model;
+    int power;
+    OdomCalibration calibration;
+
+    /**
+     * Waits until the encoders stop changing
+     * @param  oend     Final encoder values (the latest ones if it timed out)
+     * @param  itimeout Time to give up after in ms
+     * @return          False if the encoders were still changing after itimeout
+     */
+    bool waitForStop(std::array<int, 2>& oend, const unsigned long itimeout);
+
+    /**
+     * Solves for the turn scale
+     * @param  idegrees Degrees turned counterclockwise
+     * @param  istart   Encoder values before the turn
+     * @param  iend     Encoder values after the turn
+     * @return          False if the encoders did not turn counterclockwise
+     */
+    bool solveTurn(const float idegrees, const std::array<int, 2>& istart, const std::array<int, 2>& iend);
+  };
+}
+
+#endif /* end of include guard: OKAPI_ODOMCALIBRATOR */
@@ -1,6 +1,7 @@
 #ifndef OKAPI_ODOMMATH
 #define OKAPI_ODOMMATH
 
+#include <cstddef>
 #include <tuple>
 #include "odometry/odometry.h"
 
@@ -49,6 +50,33 @@ namespace okapi {
      */
     static DistanceAndAngle computeDistanceAndAngleToPoint(const float ix, const float iy, const OdomState& istate);
 
+    /**
+     * Computes the distance and angle from the given Odometry state to many points at once. The
+     * points are passed as separate x and y arrays and every step is a straight line loop with
+     * no branches, so the compiler can vectorize it on a computer and the Cortex does not stall
+     * on mispredicted branches. Use this to pick among many targets every iteration
+     * @param  ix         X coordinates
+     * @param  iy         Y coordinates
+     * @param  icount     Number of points
+     * @param  istate     Odometry state
+     * @param  odistances Where to put the distances (icount entries)
+     * @param  oangles    Where to put the angles in degrees, wrapped to [-180, 180) (icount
+     *                    entries), or nullptr to skip them
+     * @return            Index of the closest point, or icount if there are no points
+     */
+    static std::size_t computeDistancesAndAnglesToPoints(const float *ix, const float *iy, const std::size_t icount, const OdomState& istate, float *odistances, float *oangles = nullptr);
+
+    /**
+     * Finds the point closest to the given Odometry state. Cheaper than
+     * computeDistancesAndAnglesToPoints because it compares squared distances
+     * @param  ix     X coordinates
+     * @param  iy     Y coordinates
+     * @param  icount Number of points
+     * @param  istate Odometry state
+     * @return        Index of the closest point, or icount if there are no points
+     */
+    static std::size_t findClosestPoint(const float *ix, const float *iy, const std::size_t icount, const OdomState& istate);
+
     /**
      * Attempt to guess scales based on robot dimensions
      * @param chassisDiam Center-to-center wheelbase diameter in inches
@@ -0,0 +1,148 @@
+#ifndef OKAPI_ODOMRECORDER
+#define OKAPI_ODOMRECORDER
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include "util/spscQueue.h"
+#include "PAL/PAL.h"
+
+namespace okapi {
+  class OdomSample {
+  public:
+    static constexpr std::size_t channels = 4;
+
+    /**
+     * Raw sensor values read by one odometry iteration
+     * @param itimestamp PAL::micros when the sensors were read
+     * @param iticks     Left, right, lateral, and gyro ticks (0 for sensors which are not used)
+     */
+    OdomSample(const unsigned long itimestamp, const std::array<int, channels>& iticks):
+      timestamp(itimestamp),
+      ticks(iticks) {}
+
+    OdomSample():
+      timestamp(0),
+      ticks{} {}
+
+    unsigned long timestamp;
+    std::array<int, channels> ticks;
+  };
+
+  class OdomRecorder {
+  public:
+    static constexpr std::size_t queueSize = 64;
+
+    /**
+     * Logs the raw sensor values Odometry reads every iteration to a file in flash, so a run can
+     * be replayed later through a different configuration or estimator (see tools/odomReplay.cpp).
+     * Odometry hands samples over through a lock-free queue and a low priority task writes them
+     * out, so recording never blocks the odometry task. Samples are stored as differences from
+     * the previous one, 10 bytes each, so a minute at 15 ms takes about 40 kB.
+     *
+     * Attach it with Odometry::setRecorder, then call start()
+     * @param ifile        File name (at most 8 characters)
+     * @param iflushPeriod Time between writes to the file in ms
+     */
+    explicit OdomRecorder(const char *ifile = "odomlog", const unsigned long iflushPeriod = 100):
+      file(ifile),
+      flushPeriod(iflushPeriod),
+      stream(nullptr),
+      isRecording(false),
+      hasLast(false),
+      dropped(0),
+      written(0) {}
+
+    /**
+     * Opens the file and spins up the writer task at the lowest priority
+     * @return False if already recording or the file could not be opened
+     */
+    bool start();
+
+    /**
+     * Stops recording. The writer task writes out what is queued and closes the file within one
+     * flush period
+     */
+    void stop() { isRecording = false; }
+
+    /**
+     * Queues a sample. Never blocks; drops the sample if the writer task has fallen behind.
+     * Odometry calls this
+     * @param isample Sample
+     */
+    void record(const OdomSample& isample);
+
+    /**
+     * Returns the number of samples dropped because the queue was full
+     */
+    unsigned long getDroppedCount() const { return dropped; }
+
+    /**
+     * Returns the number of samples written to the file
+     */
+    unsigned long getWrittenCount() const { return written; }
+
+    /**
+     * Write to the file in a loop until stopped
+     */
+    void loop();
+
+    static void trampoline(void *context) { static_cast<OdomRecorder*>(context)->loop(); }
+  private:
+    const char *file;
+    const unsigned long flushPeriod;
+    PROS_FILE *stream;
+    std::atomic<bool> isRecording;
+    SpscQueue<OdomSample, queueSize> queue;
+    OdomSample last; //Last sample written, which the next one is stored relative to
+    bool hasLast;
+    std::atomic<unsigned long> dropped;
+    unsigned long written;
+
+    /**
+     * Writes every queued sample to the file
+     */
+    void flush();
+  };
+
+  class OdomLogReader {
+  public:
+    /**
+     * Reads a log written by an OdomRecorder
+     */
+    OdomLogReader():
+      stream(nullptr),
+      last(),
+      hasLast(false) {}
+
+    ~OdomLogReader() { close(); }
+
+    OdomLogReader(const OdomLogReader&) = delete;
+    OdomLogReader& operator=(const OdomLogReader&) = delete;
+
+    /**
+     * Opens a log
+     * @param  ifile File name
+     * @return       False if the file could not be opened or is not a log
+     */
+    bool open(const char *ifile);
+
+    /**
+     * Reads the next sample
+     * @param  osample Where to put the sample
+     * @return         False at the end of the log (a sample cut off by a power loss counts as the end)
+     */
+    bool next(OdomSample& osample);
+
+    /**
+     * Closes the log
+     */
+    void close();
+  private:
+    PROS_FILE *stream;
+    OdomSample last;
+    bool hasLast;
+  };
+}
+
+#endif /* end of include guard: OKAPI_ODOMRECORDER */
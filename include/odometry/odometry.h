@@ -2,10 +2,19 @@
 #define OKAPI_ODOMETRY
 
 #include "chassis/chassisModel.h"
-#include <valarray>
+#include "device/rotarySensor.h"
+#include "util/doubleBuffer.h"
+#include "util/historyBuffer.h"
+#include "util/mathUtil.h"
+#include <array>
+#include <cstdint>
 #include <memory>
 
 namespace okapi {
+  class OdomRecorder;
+  class PoseEstimator;
+  class Relocalizer;
+
   class OdomState {
   public:
     OdomState(const float ix, const float iy, const float itheta):
@@ -23,34 +32,200 @@ namespace okapi {
     float x, y, theta;
   };
 
+  class TimedOdomState {
+  public:
+    TimedOdomState(const unsigned long itimestamp, const OdomState& istate):
+      timestamp(itimestamp),
+      state(istate) {}
+
+    TimedOdomState():
+      timestamp(0),
+      state() {}
+
+    unsigned long timestamp; //PAL::micros when the sensors were read
+    OdomState state;
+  };
+
+  class TrackingWheel {
+  public:
+    /**
+     * An unpowered wheel used only for odometry
+     * @param isensor Sensor on the wheel
+     * @param iscale  Scale converting sensor ticks to mm of travel
+     * @param ioffset Distance in mm from the tracking center to the wheel, measured to the
+     *                wheel's side: left for the left wheel, right for the right wheel, and
+     *                backwards for the lateral wheel
+     */
+    TrackingWheel(const std::shared_ptr<RotarySensor>& isensor, const float iscale, const float ioffset):
+      sensor(isensor),
+      scale(iscale),
+      offset(ioffset) {}
+
+    TrackingWheel():
+      sensor(nullptr),
+      scale(0),
+      offset(0) {}
+
+    std::shared_ptr<RotarySensor> sensor;
+    float scale, offset;
+  };
+
+  class OdomGyroParams {
+  public:
+    /**
+     * Gyro heading fusion for Odometry. Each iteration the heading from the wheels is pulled a
+     * fraction of the way toward the gyro's heading: a small fraction when turning slowly, where
+     * the wheels are precise and the gyro's noise and drift dominate, and a large one when
+     * turning fast, where the wheels scrub and the gyro is trustworthy. Whenever the wheels have
+     * not moved for a few iterations, the gyro's drift rate is learned and then subtracted. The
+     * drift is averaged over a long window because it is usually far less than one gyro unit per
+     * iteration
+     * @param igyro     Gyro, counting up counterclockwise
+     * @param iscale    Degrees per gyro unit
+     * @param iminGain  Fraction of the gap closed each iteration when not turning
+     * @param imaxGain  Fraction of the gap closed each iteration when turning at ifullRate or faster
+     * @param ifullRate Turn rate in degrees per second at which imaxGain applies
+     * @param ibiasWindow Seconds of stationary time the drift estimate averages over
+     */
+    OdomGyroParams(const std::shared_ptr<RotarySensor>& igyro, const float iscale = 1, const float iminGain = 0.02, const float imaxGain = 0.3, const float ifullRate = 90, const float ibiasWindow = 10):
+      gyro(igyro),
+      scale(iscale),
+      minGain(iminGain),
+      maxGain(imaxGain),
+      fullRate(ifullRate),
+      biasWindow(ibiasWindow) {}
+
+    OdomGyroParams():
+      OdomGyroParams(nullptr) {}
+
+    std::shared_ptr<RotarySensor> gyro;
+    float scale, minGain, maxGain, fullRate, biasWindow;
+  };
+
   class OdomParams {
   public:
-    OdomParams(const ChassisModelParams& iparams, const float iscale, const float iturnScale):
+    OdomParams(const ChassisModelParams& iparams, const float iscale, const float iturnScale, const OdomGyroParams& igyro = OdomGyroParams()):
       model(iparams.make()),
       scale(iscale),
-      turnScale(iturnScale) {}
+      turnScale(iturnScale),
+      mismatch(0),
+      gyro(igyro),
+      estimator(nullptr),
+      relocalizer(nullptr),
+      recorder(nullptr) {}
+
+    /**
+     * Odometry which reads tracking wheels instead of the drive sensors. The model is still used
+     * to drive the robot, and its sensors are read instead if ileft or iright has no sensor
+     * @param iparams Chassis model
+     * @param ileft   Left tracking wheel, parallel to the drive
+     * @param iright  Right tracking wheel, parallel to the drive
+     * @param ilateral Tracking wheel perpendicular to the drive, counting up when the robot moves
+     *                 left. Pass TrackingWheel() if there is none
+     * @param igyro    Gyro fusion, or OdomGyroParams() for none
+     */
+    OdomParams(const ChassisModelParams& iparams, const TrackingWheel& ileft, const TrackingWheel& iright, const TrackingWheel& ilateral, const OdomGyroParams& igyro = OdomGyroParams()):
+      model(iparams.make()),
+      scale(0),
+      turnScale(0),
+      mismatch(0),
+      left(ileft),
+      right(iright),
+      lateral(ilateral),
+      gyro(igyro),
+      estimator(nullptr),
+      relocalizer(nullptr),
+      recorder(nullptr) {}
 
     virtual ~OdomParams() = default;
 
     std::shared_ptr<ChassisModel> model;
     float scale, turnScale;
+    float mismatch; //Wheel diameter mismatch, see Odometry::setScales
+    TrackingWheel left, right, lateral; //Only used if left and right both have a sensor
+    OdomGyroParams gyro; //Only used if it has a gyro
+    std::shared_ptr<PoseEstimator> estimator; //Replaces the integrator if set
+    std::shared_ptr<Relocalizer> relocalizer; //Corrects the pose with range sensors if set
+    std::shared_ptr<OdomRecorder> recorder; //Logs the raw sensor values if set
   };
 
   class Odometry {
   public:
     Odometry(const ChassisModelParams& imodelParams, const float iscale, const float iturnScale):
       model(imodelParams.make()),
+      appliedResets(0),
       scale(iscale),
       turnScale(iturnScale),
-      lastTicks{0, 0},
-      mm(0) {}
+      mismatch(0),
+      lastTicks{{0, 0}},
+      heading(0),
+      lastWheelTicks{{0, 0, 0}},
+      timestamp(0),
+      lastGyroTicks(0),
+      hasGyroTicks(false),
+      stationaryCount(0),
+      stationaryAngle(0),
+      stationaryTime(0),
+      gyroHeading(0),
+      fusedHeading(0),
+      gyroBias(0) {}
 
     Odometry(const OdomParams& iparams):
       model(iparams.model),
+      appliedResets(0),
       scale(iparams.scale),
       turnScale(iparams.turnScale),
-      lastTicks{0, 0},
-      mm(0) {}
+      mismatch(iparams.mismatch),
+      lastTicks{{0, 0}},
+      heading(0),
+      left(iparams.left),
+      right(iparams.right),
+      lateral(iparams.lateral),
+      lastWheelTicks{{0, 0, 0}},
+      timestamp(0),
+      gyroParams(iparams.gyro),
+      lastGyroTicks(0),
+      hasGyroTicks(false),
+      stationaryCount(0),
+      stationaryAngle(0),
+      stationaryTime(0),
+      gyroHeading(0),
+      fusedHeading(0),
+      gyroBias(0),
+      estimator(iparams.estimator),
+      relocalizer(iparams.relocalizer),
+      recorder(iparams.recorder) {}
+
+    /**
+     * Odometry from tracking wheels. Each iteration measures a full 2D displacement, so the pose
+     * stays accurate when the robot is pushed sideways or strafes. ileft and iright both need a
+     * sensor; without them the pose only changes through setState()
+     * @param ileft    Left tracking wheel, parallel to the drive
+     * @param iright   Right tracking wheel, parallel to the drive
+     * @param ilateral Tracking wheel perpendicular to the drive, counting up when the robot moves
+     *                 left. Pass TrackingWheel() if there is none
+     */
+    Odometry(const TrackingWheel& ileft, const TrackingWheel& iright, const TrackingWheel& ilateral):
+      model(nullptr),
+      appliedResets(0),
+      scale(0),
+      turnScale(0),
+      mismatch(0),
+      lastTicks{{0, 0}},
+      heading(0),
+      left(ileft),
+      right(iright),
+      lateral(ilateral),
+      lastWheelTicks{{0, 0, 0}},
+      timestamp(0),
+      lastGyroTicks(0),
+      hasGyroTicks(false),
+      stationaryCount(0),
+      stationaryAngle(0),
+      stationaryTime(0),
+      gyroHeading(0),
+      fusedHeading(0),
+      gyroBias(0) {}
 
     /**
      * Sets the parameters for Odometry math
@@ -60,18 +235,75 @@ namespace okapi {
       model = iparams.model;
       scale = iparams.scale;
       turnScale = iparams.turnScale;
+      mismatch = iparams.mismatch;
+      left = iparams.left;
+      right = iparams.right;
+      lateral = iparams.lateral;
+      setGyro(iparams.gyro);
+      setEstimator(iparams.estimator);
+      setRelocalizer(iparams.relocalizer);
+      setRecorder(iparams.recorder);
+    }
+
+    /**
+     * Hands the pose over to an extended Kalman filter. Each iteration the wheel motion becomes
+     * the filter's prediction and the gyro (if any) one of its corrections, and the state
+     * Odometry reports is the filter's. Call this before odometry starts running
+     * @param iestimator Filter, or nullptr to integrate the wheels directly
+     */
+    void setEstimator(const std::shared_ptr<PoseEstimator>& iestimator) { estimator = iestimator; }
+
+    /**
+     * Corrects the pose with ultrasonic ranges to known walls every iteration. Call this before
+     * odometry starts running
+     * @param irelocalizer Relocalizer, or nullptr for none
+     */
+    void setRelocalizer(const std::shared_ptr<Relocalizer>& irelocalizer) { relocalizer = irelocalizer; }
+
+    /**
+     * Logs the sensor values every iteration reads, for replaying the run on a computer later
+     * @param irecorder Recorder, or nullptr for none
+     */
+    void setRecorder(const std::shared_ptr<OdomRecorder>& irecorder) { recorder = irecorder; }
+
+    /**
+     * Sets up gyro heading fusion. Call this before odometry starts running
+     * @param iparams Gyro fusion parameters, or OdomGyroParams() to turn fusion off
+     */
+    void setGyro(const OdomGyroParams& iparams) {
+      gyroParams = iparams;
+      hasGyroTicks = false;
+      stationaryAngle = 0;
+      stationaryTime = 0;
+      gyroBias = 0;
     }
 
+    /**
+     * Returns the gyro drift rate learned while the robot was stationary
+     * @return Drift in degrees per second
+     */
+    float getGyroBias() const { return gyroBias * radianToDegree; }
+
     /**
      * Set the drive and turn scales
      * @param iscale     Scale converting encoder ticks to mm
-     * @param iturnScale Scale converting encoder ticks to radians
+     * @param iturnScale Scale converting encoder ticks to degrees (applied to half the right minus left ticks)
+     * @param imismatch  How much bigger the left wheels are than the right ones, as a fraction:
+     *                   left ticks count for 1 + imismatch and right ticks for 1 - imismatch
      */
-    void setScales(const float iscale, const float iturnScale) {
+    void setScales(const float iscale, const float iturnScale, const float imismatch = 0) {
       scale = iscale;
       turnScale = iturnScale;
+      mismatch = imismatch;
     }
 
+    /**
+     * Do one iteration of odom math. The motion since the last iteration is integrated as an
+     * exact circular arc, so the result does not depend on the update period for constant
+     * curvature motion
+     */
+    void step();
+
     /**
      * Do odom math in an infinite loop
      */
@@ -79,13 +311,94 @@ namespace okapi {
 
     static void trampoline(void *context) { static_cast<Odometry*>(context)->loop(); }
 
-    OdomState getState() { return state; }
+    /**
+     * Returns the most recently published state. Never blocks the odometry task and never
+     * returns a pose mixed from two iterations
+     * @return Most recent state
+     */
+    OdomState getState() const { return published.read(); }
+
+    /**
+     * Moves the robot to a pose, e.g. its starting spot on the field. Takes effect on the next
+     * iteration. With a PoseEstimator attached, use PoseEstimator::setState instead
+     * @param istate Pose in the odom frame (theta in degrees)
+     */
+    void setState(const OdomState& istate) { resets.write(istate); }
+
+    /**
+     * Returns where the robot was at a past time, interpolated between the two nearest
+     * iterations. Use this to match a late measurement (an ultrasonic ping, a button press) with
+     * the pose it was taken from. Times before the oldest stored iteration (about one second ago
+     * at 15 ms) or after the newest one return that iteration's state
+     * @param  itime Time from PAL::micros
+     * @return       State at that time
+     */
+    OdomState getStateAt(const unsigned long itime) const;
+
+    /**
+     * Returns the robot's velocity in the odom frame, averaged over a recent window
+     * @param  iwindow Window to average over in us
+     * @return         Velocity: x and y in mm per second, theta in degrees per second
+     */
+    OdomState getVelocity(const unsigned long iwindow = 50000) const;
+
+    static constexpr std::size_t historySize = 64;
   private:
     std::shared_ptr<ChassisModel> model;
-    OdomState state;
-    float scale, turnScale;
-    std::valarray<int> lastTicks;
-    float mm;
+    OdomState state; //Only touched by step()
+    DoubleBuffer<OdomState> published;
+    DoubleBuffer<OdomState> resets; //Poses from setState() for step() to pick up
+    std::uint32_t appliedResets;
+    HistoryBuffer<TimedOdomState, historySize> history;
+    float scale, turnScale, mismatch;
+    std::array<int, 2> lastTicks;
+    float heading; //Radians in (-pi, pi]; state.theta is the same angle in degrees
+    TrackingWheel left, right, lateral;
+    std::array<int, 3> lastWheelTicks;
+    unsigned long timestamp; //PAL::micros when step() read the sensors
+    OdomGyroParams gyroParams;
+    int lastGyroTicks;
+    bool hasGyroTicks;
+    int stationaryCount; //Iterations in a row the wheels have not moved
+    float stationaryAngle, stationaryTime; //Gyro radians and seconds accumulated while stationary
+    float gyroHeading, fusedHeading; //Radians, not wrapped
+    float gyroBias; //Radians per second
+    std::shared_ptr<PoseEstimator> estimator;
+    std::shared_ptr<Relocalizer> relocalizer;
+    std::shared_ptr<OdomRecorder> recorder;
+
+    /**
+     * Applies a displacement measured in the robot's frame at the start of the iteration
+     * @param iforward Chord length along the robot's heading in mm
+     * @param ilateral Chord length to the robot's left in mm
+     * @param idTheta  Change in heading in radians
+     */
+    void integrate(const float iforward, const float ilateral, const float idTheta);
+
+    /**
+     * Returns the chord of an arc, the limit of which is the arc length as the angle goes to zero
+     * @param  iarc    Arc length
+     * @param  idTheta Angle the arc spans
+     * @return         Chord length
+     */
+    static float chord(const float iarc, const float idTheta);
+
+    /**
+     * Fuses the wheels' heading change with the gyro's
+     * @param  idTheta   Heading change measured by the wheels in radians
+     * @param  iisMoving Whether any wheel moved this iteration
+     * @param  idt       Time since the last iteration in seconds
+     * @return           Fused heading change in radians
+     */
+    float fuseHeading(const float idTheta, const bool iisMoving, const float idt);
+
+    /**
+     * Finds the state at a past time in the history
+     * @param  itime Time from PAL::micros
+     * @param  ostate State at that time, with the timestamp clamped to the stored range
+     * @return       False if the history is empty
+     */
+    bool lookup(const unsigned long itime, TimedOdomState& ostate) const;
   };
 }
 
@@ -0,0 +1,247 @@
+#ifndef OKAPI_POSEESTIMATOR
+#define OKAPI_POSEESTIMATOR
+
+#include "odometry/odometry.h"
+#include "util/doubleBuffer.h"
+#include "util/matrix.h"
+#include "PAL/PAL.h"
+
+namespace okapi {
+  class SensorMount {
+  public:
+    /**
+     * Where a sensor sits on the robot, relative to the tracking center
+     * @param ix     Distance forward in mm
+     * @param iy     Distance to the left in mm
+     * @param itheta Direction the sensor faces in degrees, counterclockwise from forward
+     */
+    SensorMount(const float ix, const float iy, const float itheta = 0):
+      x(ix),
+      y(iy),
+      theta(itheta) {}
+
+    SensorMount():
+      x(0),
+      y(0),
+      theta(0) {}
+
+    float x, y, theta;
+  };
+
+  class FieldSegment {
+  public:
+    /**
+     * A straight wall or line on the field, in the odom frame (mm). Everything the raycast and
+     * the pose corrections need is worked out here, so a constexpr array of segments is a
+     * finished table in flash
+     * @param ix1 X coordinate of one end
+     * @param iy1 Y coordinate of one end
+     * @param ix2 X coordinate of the other end
+     * @param iy2 Y coordinate of the other end
+     */
+    constexpr FieldSegment(const float ix1, const float iy1, const float ix2, const float iy2):
+      FieldSegment(ix1, iy1, ix2 - ix1, iy2 - iy1, invLength((ix2 - ix1) * (ix2 - ix1) + (iy2 - iy1) * (iy2 - iy1))) {}
+
+    constexpr FieldSegment():
+      x1(0),
+      y1(0),
+      dx(0),
+      dy(0),
+      normalX(0),
+      normalY(0),
+      offset(0),
+      invLengthSq(0) {}
+
+    float x1, y1; //One end
+    float dx, dy; //From that end to the other one
+    float normalX, normalY; //Unit normal, (-dy, dx) / length
+    float offset; //Points p on the segment's line satisfy p . normal = offset
+    float invLengthSq; //0 if both ends are the same point
+  private:
+    constexpr FieldSegment(const float ix1, const float iy1, const float idx, const float idy, const float iinvLength):
+      x1(ix1),
+      y1(iy1),
+      dx(idx),
+      dy(idy),
+      normalX(-idy * iinvLength),
+      normalY(idx * iinvLength),
+      offset((iy1 * idx - ix1 * idy) * iinvLength),
+      invLengthSq(iinvLength * iinvLength) {}
+
+    /**
+     * 1 / sqrt(ilengthSq), or 0 if ilengthSq is not positive. Written as single return
+     * statements so it also runs at compile time under C++11 constexpr rules
+     */
+    static constexpr float invLength(const float ilengthSq) {
+      return ilengthSq > 0 ? 1 / sqrtFrom(ilengthSq, ilengthSq + 1) : 0;
+    }
+
+    /**
+     * Newton's method on sqrt(ix) from a guess above the root. Each step only falls, so it stops
+     * at the first step which does not
+     */
+    static constexpr float sqrtFrom(const float ix, const float iroot) {
+      return (iroot + ix / iroot) / 2 >= iroot ? iroot : sqrtFrom(ix, (iroot + ix / iroot) / 2);
+    }
+  };
+
+  class PoseEstimate {
+  public:
+    PoseEstimate(const OdomState& istate, const Matrix<3, 3>& icovariance):
+      state(istate),
+      covariance(icovariance) {}
+
+    PoseEstimate():
+      state(),
+      covariance() {}
+
+    OdomState state;
+    Matrix<3, 3> covariance; //Over (x, y, theta) in mm and degrees
+  };
+
+  class PoseEstimatorParams {
+  public:
+    /**
+     * Noise model for a PoseEstimator. Motion noise is given as variance gained per unit of
+     * motion, so uncertainty grows like a random walk with distance traveled
+     * @param idistanceVariance  Position variance in mm^2 per mm driven
+     * @param iturnVariance      Heading variance in degrees^2 per degree turned
+     * @param idriftVariance     Heading variance in degrees^2 per mm driven
+     * @param igyroStdDev        Standard deviation of a single gyro reading in degrees
+     * @param igyroDriftVariance Variance in degrees^2 per second that the gyro's heading wanders
+     *                           from the true heading
+     * @param igate              Corrections further than this many standard deviations from
+     *                           the prediction are rejected as outliers
+     */
+    PoseEstimatorParams(const float idistanceVariance = 0.5, const float iturnVariance = 0.1, const float idriftVariance = 0.002, const float igyroStdDev = 0.5, const float igyroDriftVariance = 0.05, const float igate = 3):
+      distanceVariance(idistanceVariance),
+      turnVariance(iturnVariance),
+      driftVariance(idriftVariance),
+      gyroStdDev(igyroStdDev),
+      gyroDriftVariance(igyroDriftVariance),
+      gate(igate) {}
+
+    float distanceVariance, turnVariance, driftVariance, gyroStdDev, gyroDriftVariance, gate;
+  };
+
+  class PoseEstimator {
+  public:
+    /**
+     * Extended Kalman filter over the robot's pose (x, y, theta). Wheel motion from Odometry is
+     * the prediction; gyro headings, ultrasonic ranges to known walls, and line sensor crossings
+     * are corrections. Every correction is a single scalar measurement, so an update is a few
+     * dozen multiplies on 4x4 matrices with no inversion and no heap. The fourth state is the
+     * offset between the gyro's heading and the true heading, which lets range and line
+     * corrections fix the heading without the gyro dragging it back.
+     *
+     * Attach it to an Odometry through OdomParams::estimator and Odometry will feed it every
+     * iteration and report its pose. Corrections may come from any task.
+     * @param iparams Noise model
+     */
+    PoseEstimator(const PoseEstimatorParams& iparams = PoseEstimatorParams());
+
+    /**
+     * Sets the noise model
+     * @param iparams Noise model
+     */
+    void setParams(const PoseEstimatorParams& iparams);
+
+    /**
+     * Returns the noise model
+     * @return Noise model
+     */
+    PoseEstimatorParams getParams() const { return params; }
+
+    /**
+     * Sets the pose and its uncertainty, e.g. at the start of autonomous
+     * @param istate       Pose in the odom frame (theta in degrees)
+     * @param ixyStdDev    Standard deviation of x and y in mm
+     * @param ithetaStdDev Standard deviation of theta in degrees
+     */
+    void setState(const OdomState& istate, const float ixyStdDev, const float ithetaStdDev);
+
+    /**
+     * Moves the pose by a displacement measured in the robot's frame at the start of the
+     * iteration and grows the covariance to match
+     * @param iforward Chord length along the robot's heading in mm
+     * @param ilateral Chord length to the robot's left in mm
+     * @param idTheta  Change in heading in radians
+     */
+    void predict(const float iforward, const float ilateral, const float idTheta);
+
+    /**
+     * Corrects the heading with an absolute heading measurement
+     * @param  itheta  Measured heading in degrees, counterclockwise positive
+     * @param  istdDev Standard deviation of the measurement in degrees
+     * @return         False if the measurement was rejected as an outlier
+     */
+    bool correctHeading(const float itheta, const float istdDev);
+
+    /**
+     * Corrects the heading with a gyro reading. The gyro's zero is arbitrary, so the first
+     * reading after construction or setState() only records the offset between the gyro and the
+     * estimate; later readings are corrections with the gyro noise from the params
+     * @param  igyroHeading Gyro heading in degrees, counterclockwise positive, not wrapped
+     * @return              False if the reading was rejected as an outlier
+     */
+    bool correctGyro(const float igyroHeading);
+
+    /**
+     * Corrects the pose with a range to a known wall
+     * @param  imount  Where the range sensor is on the robot
+     * @param  iwall   Wall the sensor is pointing at
+     * @param  irange  Measured range in mm (RangeFinder reads cm)
+     * @param  istdDev Standard deviation of the measurement in mm
+     * @return         False if the measurement was rejected: the beam misses the wall, hits it
+     *                 nearly edge on, or is too far from the expected range
+     */
+    bool correctRange(const SensorMount& imount, const FieldSegment& iwall, const float irange, const float istdDev);
+
+    /**
+     * Corrects the pose with a line sensor which just crossed a line on the field
+     * @param  imount  Where the line sensor is on the robot (theta is unused)
+     * @param  iline   Line the sensor crossed
+     * @param  istdDev Standard deviation of the sensor's position when it triggers in mm
+     * @return         False if the measurement was rejected as an outlier or the sensor is past
+     *                 the end of the line
+     */
+    bool correctLine(const SensorMount& imount, const FieldSegment& iline, const float istdDev);
+
+    /**
+     * Returns the most recent pose. Never blocks
+     * @return Pose in the odom frame (theta in degrees)
+     */
+    OdomState getState() const { return published.read().state; }
+
+    /**
+     * Returns the most recent pose with its covariance. Never blocks
+     * @return Pose and covariance
+     */
+    PoseEstimate getEstimate() const { return published.read(); }
+  private:
+    PoseEstimatorParams params;
+    float x, y, theta; //mm, mm, radians in (-pi, pi]
+    float gyroOffset; //Radians, theta minus the gyro's heading
+    Matrix<4, 4> covariance; //Over (x, y, theta, gyroOffset) in mm and radians
+    bool hasGyroOffset;
+    unsigned long lastGyroTime; //PAL::micros of the last gyro reading
+    DoubleBuffer<PoseEstimate> published;
+    Mutex mutex;
+
+    /**
+     * Applies one scalar measurement. Call with the mutex held
+     * @param  ijacobian   Derivative of the measurement with respect to the state
+     * @param  iinnovation Measurement minus its predicted value
+     * @param  ivariance   Variance of the measurement
+     * @return             False if the measurement was outside the gate
+     */
+    bool update(const Matrix<1, 4>& ijacobian, const float iinnovation, const float ivariance);
+
+    /**
+     * Publishes the estimate. Call with the mutex held
+     */
+    void publish();
+  };
+}
+
+#endif /* end of include guard: OKAPI_POSEESTIMATOR */
@@ -0,0 +1,121 @@
+#ifndef OKAPI_PUREPURSUIT
+#define OKAPI_PUREPURSUIT
+
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include "odometry/odometry.h"
+
+namespace okapi {
+  class Waypoint {
+  public:
+    Waypoint(const float ix, const float iy):
+      x(ix),
+      y(iy) {}
+
+    Waypoint():
+      x(0),
+      y(0) {}
+
+    float x, y;
+  };
+
+  class PurePursuitParams {
+  public:
+    /**
+     * Parameters for a pure pursuit path follower. Distances are in the units of the odom frame
+     * (mm), powers are motor powers
+     * @param ilookahead     Distance from the robot to the point it steers toward
+     * @param itrackWidth    Center-to-center distance between the left and right wheels
+     * @param imaxPower      Power on straight sections of the path
+     * @param iturnPowerGain Power limit on curves is this divided by the curvature (1/mm), so
+     *                       tighter curves are driven slower. 0 disables the limit
+     * @param iminPower      Smallest power the robot will slow down to
+     * @param iendThreshold  The path is done once the robot is this close to the last waypoint
+     *                       (or once it is past the last waypoint along the last segment)
+     */
+    PurePursuitParams(const float ilookahead, const float itrackWidth, const float imaxPower = 100, const float iturnPowerGain = 0, const float iminPower = 20, const float iendThreshold = 20):
+      lookahead(ilookahead),
+      trackWidth(itrackWidth),
+      maxPower(imaxPower),
+      turnPowerGain(iturnPowerGain),
+      minPower(iminPower),
+      endThreshold(iendThreshold) {}
+
+    float lookahead, trackWidth, maxPower, turnPowerGain, minPower, endThreshold;
+  };
+
+  class PurePursuitOutput {
+  public:
+    PurePursuitOutput(const float idistPower, const float ianglePower, const bool iisDone):
+      distPower(idistPower),
+      anglePower(ianglePower),
+      isDone(iisDone) {}
+
+    float distPower, anglePower; //For ChassisModel::driveVector
+    bool isDone;
+  };
+
+  class PurePursuit {
+  public:
+    static constexpr std::size_t maxWaypoints = 32;
+
+    /**
+     * Pure pursuit path follower. Each step it finds the point on the path one lookahead distance
+     * ahead of the robot and drives the arc which passes through it, so a path with many
+     * waypoints is followed in one continuous motion
+     * @param iparams Follower parameters
+     */
+    PurePursuit(const PurePursuitParams& iparams):
+      params(iparams),
+      count(0),
+      segment(0),
+      segmentFraction(0),
+      curvature(0) {}
+
+    /**
+     * Sets the follower parameters
+     * @param iparams Follower parameters
+     */
+    void setParams(const PurePursuitParams& iparams) { params = iparams; }
+
+    /**
+     * Sets the path to follow, starting from the robot's current position. Waypoints past
+     * maxWaypoints - 1 are dropped
+     * @param  istart     Robot's current state
+     * @param  iwaypoints Waypoints in the odom frame
+     * @return            False if any waypoints were dropped
+     */
+    bool setPath(const OdomState& istart, std::initializer_list<Waypoint> iwaypoints);
+
+    /**
+     * Does one iteration of the follower
+     * @param  istate Robot's current state (theta in degrees, counterclockwise positive)
+     * @return        Powers for ChassisModel::driveVector and whether the path is done
+     */
+    PurePursuitOutput step(const OdomState& istate);
+
+    /**
+     * Returns the curvature of the most recent arc
+     * @return Curvature in 1/mm, counterclockwise positive
+     */
+    float getCurvature() const { return curvature; }
+  private:
+    PurePursuitParams params;
+    std::array<Waypoint, maxWaypoints> path;
+    std::size_t count;
+    std::size_t segment; //Segment the lookahead point is on
+    float segmentFraction; //How far along that segment it is, from 0 to 1
+    float curvature;
+
+    /**
+     * Finds the point one lookahead distance ahead of the robot, never moving backwards along the
+     * path
+     * @param  istate Robot's current state
+     * @return        Lookahead point
+     */
+    Waypoint findLookahead(const OdomState& istate);
+  };
+}
+
+#endif /* end of include guard: OKAPI_PUREPURSUIT */
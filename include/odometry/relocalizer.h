@@ -0,0 +1,111 @@
+#ifndef OKAPI_RELOCALIZER
+#define OKAPI_RELOCALIZER
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include "device/rangeFinder.h"
+#include "odometry/fieldMap.h"
+#include "odometry/poseEstimator.h"
+
+namespace okapi {
+  class RelocalizerParams {
+  public:
+    /**
+     * Parameters for a Relocalizer
+     * @param imaxCorrection Largest shift in mm applied for one reading
+     * @param iagreement     Readings further than this in mm from the expected range are ignored
+     *                       (a robot or game object is in the way, or the pose is badly off)
+     * @param igain          Fraction of the disagreement corrected for one reading (0 to 1)
+     * @param iminIncidence  Readings from walls hit further than this from head on are ignored,
+     *                       as the cosine of the angle (ultrasonic pings glance off walls hit at
+     *                       a shallow angle)
+     * @param istdDev        Standard deviation of a reading in mm, used with a PoseEstimator
+     * @param iperiod        Time between readings in ms
+     */
+    RelocalizerParams(const float imaxCorrection = 10, const float iagreement = 100, const float igain = 0.25, const float iminIncidence = 0.7, const float istdDev = 30, const unsigned long iperiod = 50):
+      maxCorrection(imaxCorrection),
+      agreement(iagreement),
+      gain(igain),
+      minIncidence(iminIncidence),
+      stdDev(istdDev),
+      period(iperiod) {}
+
+    float maxCorrection, agreement, gain, minIncidence, stdDev;
+    unsigned long period;
+  };
+
+  class Relocalizer {
+  public:
+    static constexpr std::size_t maxSensors = 4;
+
+    /**
+     * Corrects the odometry pose with ultrasonic ranges to the walls of a known field. For each
+     * reading it raycasts the range the sensor should see from the current pose, and if the
+     * reading agrees, shifts the pose toward agreeing exactly, a bounded amount at a time.
+     *
+     * Attach it to an Odometry through OdomParams::relocalizer and Odometry will run it every
+     * iteration. With a PoseEstimator attached too, readings go to the estimator as range
+     * corrections instead, which can also fix the heading.
+     * @param imap    Field map (its walls must outlive the Relocalizer)
+     * @param iparams Relocalizer parameters
+     */
+    Relocalizer(const FieldMap& imap, const RelocalizerParams& iparams = RelocalizerParams());
+
+    /**
+     * Adds a range sensor. Call this before odometry starts running
+     * @param  isensor Sensor
+     * @param  imount  Where the sensor is on the robot
+     * @return         False if there are already maxSensors sensors
+     */
+    bool addSensor(const std::shared_ptr<RangeFinder>& isensor, const SensorMount& imount);
+
+    /**
+     * Reads the sensors if a period has passed since the last reading and works out the
+     * correction. Odometry calls this
+     * @param  istate     Current pose (theta in degrees)
+     * @param  iestimator Estimator to send readings to, or nullptr to return a correction
+     * @return            Shift to add to the pose (x and y in mm, theta always 0)
+     */
+    OdomState step(const OdomState& istate, PoseEstimator *iestimator);
+
+    /**
+     * Returns the range a sensor should read from a pose
+     * @param  istate Pose (theta in degrees)
+     * @param  imount Where the sensor is on the robot
+     * @param  ohit   Where the sensor's ray hits the field
+     * @return        False if the ray hits no wall
+     */
+    bool getExpectedRange(const OdomState& istate, const SensorMount& imount, RaycastHit& ohit) const;
+
+    /**
+     * Returns the number of readings used so far
+     */
+    unsigned long getAcceptedCount() const { return accepted; }
+
+    /**
+     * Returns the number of readings ignored so far
+     */
+    unsigned long getRejectedCount() const { return rejected; }
+  private:
+    class Sensor {
+    public:
+      Sensor():
+        sensor(nullptr),
+        mount() {}
+
+      std::shared_ptr<RangeFinder> sensor;
+      SensorMount mount;
+    };
+
+    const FieldMap map;
+    RelocalizerParams params;
+    std::array<Sensor, maxSensors> sensors;
+    std::size_t count;
+    unsigned long lastRun;
+    bool hasRun;
+    unsigned long accepted, rejected;
+  };
+}
+
+#endif /* end of include guard: OKAPI_RELOCALIZER */
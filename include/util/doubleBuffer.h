@@ -0,0 +1,75 @@
+#ifndef OKAPI_DOUBLEBUFFER
+#define OKAPI_DOUBLEBUFFER
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace okapi {
+  /**
+   * Single writer, many reader publication of a value without locks. The writer fills the back
+   * buffer while readers copy the front one; a sequence counter lets a reader detect the rare
+   * case where it was preempted across a publish, and it simply copies again. Readers never
+   * block the writer.
+   */
+  template<typename T>
+  class DoubleBuffer {
+  public:
+    DoubleBuffer():
+      buffers(),
+      seq(0) {}
+
+    explicit DoubleBuffer(const T& iinitial):
+      buffers{{iinitial, iinitial}},
+      seq(0) {}
+
+    /**
+     * Returns the buffer the writer should fill. Only the writer may call this
+     * @return Back buffer
+     */
+    T& getBack() { return buffers[(seq.load(std::memory_order_relaxed) + 1) & 1]; }
+
+    /**
+     * Makes the back buffer the new front buffer. Only the writer may call this
+     */
+    void publish() { seq.fetch_add(1, std::memory_order_release); }
+
+    /**
+     * Copies a value into the back buffer and publishes it. Only the writer may call this
+     * @param ival New value
+     */
+    void write(const T& ival) {
+      getBack() = ival;
+      publish();
+    }
+
+    /**
+     * Returns a consistent copy of the most recently published value
+     * @return Most recently published value
+     */
+    T read() const {
+      std::uint32_t before, after;
+      T out;
+
+      do {
+        before = seq.load(std::memory_order_acquire);
+        out = buffers[before & 1];
+        std::atomic_signal_fence(std::memory_order_acq_rel);
+        after = seq.load(std::memory_order_acquire);
+      } while (before != after);
+
+      return out;
+    }
+
+    /**
+     * Returns the number of values published so far
+     * @return Number of publishes
+     */
+    std::uint32_t getCount() const { return seq.load(std::memory_order_acquire); }
+  private:
+    std::array<T, 2> buffers;
+    std::atomic<std::uint32_t> seq;
+  };
+}
+
+#endif /* end of include guard: OKAPI_DOUBLEBUFFER */
@@ -0,0 +1,84 @@
+#ifndef OKAPI_FASTMATH
+#define OKAPI_FASTMATH
+
+#include <cstdint>
+#include <cstring>
+
+namespace okapi {
+  /**
+   * Trig and square roots for the odometry and path code without libm. The Cortex has no FPU, so
+   * libm's sin, cos, atan2, and sqrt each cost thousands of cycles of soft-float math; these use
+   * 257 entry tables kept in flash, or bit tricks, and a handful of float operations instead.
+   *
+   * Every function takes an Accuracy. fine (the default) interpolates between table entries or
+   * runs an extra Newton step and is good to about 5e-6; coarse skips that and is good to about
+   * 3e-3 (radians or relative error) for roughly half the cost.
+   */
+  class FastMath {
+  public:
+    enum class Accuracy { coarse, fine };
+
+    /**
+     * Sine of an angle in radians
+     */
+    static float sin(const float ix, const Accuracy iaccuracy = Accuracy::fine) {
+      return sinTableUnits(ix * tableUnitsPerRadian, iaccuracy);
+    }
+
+    /**
+     * Cosine of an angle in radians
+     */
+    static float cos(const float ix, const Accuracy iaccuracy = Accuracy::fine) {
+      return sinTableUnits(ix * tableUnitsPerRadian + static_cast<float>(tableSize), iaccuracy);
+    }
+
+    /**
+     * Angle of the point (ix, iy) from the x axis in radians, in [-pi, pi]
+     */
+    static float atan2(const float iy, const float ix, const Accuracy iaccuracy = Accuracy::fine);
+
+    /**
+     * 1 / sqrt(ix) for ix > 0
+     */
+    static float invSqrt(const float ix, const Accuracy iaccuracy = Accuracy::fine) {
+      std::uint32_t bits;
+      std::memcpy(&bits, &ix, sizeof(bits));
+      bits = 0x5F3759DF - (bits >> 1);
+      float y;
+      std::memcpy(&y, &bits, sizeof(y));
+
+      y *= 1.5 - 0.5 * ix * y * y;
+      if (iaccuracy == Accuracy::fine)
+        y *= 1.5 - 0.5 * ix * y * y;
+
+      return y;
+    }
+
+    /**
+     * Square root of ix, or 0 if ix is not positive
+     */
+    static float sqrt(const float ix, const Accuracy iaccuracy = Accuracy::fine) {
+      return ix > 0 ? ix * invSqrt(ix, iaccuracy) : 0;
+    }
+
+    static constexpr int tableSize = 256; //Entries per quarter turn (and per unit of atan's argument), plus one
+  private:
+    FastMath() {}
+
+    static constexpr float tableUnitsPerRadian = tableSize * 2 / 3.14159265358979323846;
+    static const float sinTable[tableSize + 1]; //sin over [0, pi / 2]
+    static const float atanTable[tableSize + 1]; //atan over [0, 1]
+
+    /**
+     * Sine of an angle measured in quarter turns * tableSize
+     */
+    static float sinTableUnits(const float iunits, const Accuracy iaccuracy);
+
+    /**
+     * atan of a ratio in [0, 1]
+     */
+    static float atanUnit(const float iratio, const Accuracy iaccuracy);
+  };
+}
+
+#endif /* end of include guard: OKAPI_FASTMATH */
@@ -0,0 +1,69 @@
+#ifndef OKAPI_HISTORYBUFFER
+#define OKAPI_HISTORYBUFFER
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace okapi {
+  /**
+   * Fixed capacity ring of the most recent values from a single writer, readable from any task
+   * without locks. The writer fills a slot and then bumps a counter; a reader copies a slot and
+   * then checks the counter to make sure the writer did not lap it while it was copying.
+   */
+  template<typename T, std::size_t capacity>
+  class HistoryBuffer {
+    static_assert(capacity >= 2, "HistoryBuffer needs room for at least two values");
+
+  public:
+    HistoryBuffer():
+      buffer(),
+      count(0) {}
+
+    /**
+     * Adds a value, overwriting the oldest one once the buffer is full. Only the writer may call
+     * this
+     * @param ival New value
+     */
+    void push(const T& ival) {
+      const std::uint32_t n = count.load(std::memory_order_relaxed);
+      buffer[n % capacity] = ival;
+      count.store(n + 1, std::memory_order_release);
+    }
+
+    /**
+     * Copies a value out of the buffer
+     * @param  iage 0 for the newest value, 1 for the one before it, and so on
+     * @param  oval Where to copy the value
+     * @return      False if there is no such value (not written yet or already overwritten)
+     */
+    bool get(const std::size_t iage, T& oval) const {
+      const std::uint32_t before = count.load(std::memory_order_acquire);
+      if (iage >= before || iage >= capacity - 1)
+        return false;
+
+      const std::uint32_t index = before - 1 - static_cast<std::uint32_t>(iage);
+      oval = buffer[index % capacity];
+      std::atomic_signal_fence(std::memory_order_acq_rel);
+
+      //The writer overwrites value index while it writes value index + capacity, which starts as
+      //soon as count reaches index + capacity
+      return count.load(std::memory_order_acquire) - index < capacity;
+    }
+
+    /**
+     * Returns the number of values which can currently be read
+     * @return Number of readable values
+     */
+    std::size_t size() const {
+      const std::uint32_t n = count.load(std::memory_order_acquire);
+      return n < capacity - 1 ? n : capacity - 1;
+    }
+  private:
+    std::array<T, capacity> buffer;
+    std::atomic<std::uint32_t> count;
+  };
+}
+
+#endif /* end of include guard: OKAPI_HISTORYBUFFER */
@@ -4,8 +4,8 @@
 namespace okapi {
   static constexpr float analogInToV = 286.0;
   static constexpr float inchToMM = 25.4;
-  static constexpr float degreeToRadian = 0.01745;
-  static constexpr float radianToDegree = 57.2958;
+  static constexpr float degreeToRadian = 0.0174532925;
+  static constexpr float radianToDegree = 57.2957795;
   static constexpr float imeHighTorTPR = 627.2;
   static constexpr float imeHighStrTPR = 392.0;
   static constexpr float imeTurboTPR = 261.333;
@@ -0,0 +1,79 @@
+#ifndef OKAPI_MATRIX
+#define OKAPI_MATRIX
+
+#include <array>
+#include <cstddef>
+
+namespace okapi {
+  /**
+   * Fixed size, row major matrix of floats. The size is part of the type, so all storage lives
+   * inline (on the stack or in the owning object) and mismatched dimensions fail to compile
+   */
+  template<std::size_t rows, std::size_t cols>
+  class Matrix {
+  public:
+    Matrix():
+      data() {}
+
+    /**
+     * Returns the identity matrix
+     */
+    static Matrix identity() {
+      static_assert(rows == cols, "Only square matrices have an identity");
+      Matrix out;
+      for (std::size_t i = 0; i < rows; i++)
+        out(i, i) = 1;
+      return out;
+    }
+
+    float& operator()(const std::size_t irow, const std::size_t icol) { return data[irow * cols + icol]; }
+    float operator()(const std::size_t irow, const std::size_t icol) const { return data[irow * cols + icol]; }
+
+    Matrix operator+(const Matrix& rhs) const {
+      Matrix out;
+      for (std::size_t i = 0; i < rows * cols; i++)
+        out.data[i] = data[i] + rhs.data[i];
+      return out;
+    }
+
+    Matrix operator-(const Matrix& rhs) const {
+      Matrix out;
+      for (std::size_t i = 0; i < rows * cols; i++)
+        out.data[i] = data[i] - rhs.data[i];
+      return out;
+    }
+
+    Matrix operator*(const float rhs) const {
+      Matrix out;
+      for (std::size_t i = 0; i < rows * cols; i++)
+        out.data[i] = data[i] * rhs;
+      return out;
+    }
+
+    template<std::size_t rhsCols>
+    Matrix<rows, rhsCols> operator*(const Matrix<cols, rhsCols>& rhs) const {
+      Matrix<rows, rhsCols> out;
+      for (std::size_t i = 0; i < rows; i++) {
+        for (std::size_t j = 0; j < rhsCols; j++) {
+          float sum = 0;
+          for (std::size_t k = 0; k < cols; k++)
+            sum += (*this)(i, k) * rhs(k, j);
+          out(i, j) = sum;
+        }
+      }
+      return out;
+    }
+
+    Matrix<cols, rows> transpose() const {
+      Matrix<cols, rows> out;
+      for (std::size_t i = 0; i < rows; i++)
+        for (std::size_t j = 0; j < cols; j++)
+          out(j, i) = (*this)(i, j);
+      return out;
+    }
+  private:
+    std::array<float, rows * cols> data;
+  };
+}
+
+#endif /* end of include guard: OKAPI_MATRIX */
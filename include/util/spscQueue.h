@@ -0,0 +1,66 @@
+#ifndef OKAPI_SPSCQUEUE
+#define OKAPI_SPSCQUEUE
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace okapi {
+  /**
+   * Fixed capacity FIFO from one producer to one consumer without locks. The producer may be an
+   * interrupt handler or a high priority task; neither side ever blocks the other. Each index is
+   * only written by one side, and a slot is filled before the index which hands it over moves.
+   */
+  template<typename T, std::size_t capacity>
+  class SpscQueue {
+    static_assert(capacity >= 2 && (capacity & (capacity - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+  public:
+    SpscQueue():
+      buffer(),
+      head(0),
+      tail(0) {}
+
+    /**
+     * Adds a value. Only the producer may call this
+     * @param  ival Value
+     * @return      False if the queue is full (the value is dropped)
+     */
+    bool push(const T& ival) {
+      const std::uint32_t h = head.load(std::memory_order_relaxed);
+      if (h - tail.load(std::memory_order_acquire) >= capacity)
+        return false;
+
+      buffer[h & (capacity - 1)] = ival;
+      head.store(h + 1, std::memory_order_release);
+      return true;
+    }
+
+    /**
+     * Removes the oldest value. Only the consumer may call this
+     * @param  oval Where to copy the value
+     * @return      False if the queue is empty
+     */
+    bool pop(T& oval) {
+      const std::uint32_t t = tail.load(std::memory_order_relaxed);
+      if (head.load(std::memory_order_acquire) == t)
+        return false;
+
+      oval = buffer[t & (capacity - 1)];
+      tail.store(t + 1, std::memory_order_release);
+      return true;
+    }
+
+    /**
+     * Returns the number of values waiting. Exact from either side, a snapshot from anywhere else
+     */
+    std::size_t size() const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+  private:
+    std::array<T, capacity> buffer;
+    std::atomic<std::uint32_t> head; //Next slot to fill; only the producer writes it
+    std::atomic<std::uint32_t> tail; //Next slot to empty; only the consumer writes it
+  };
+}
+
+#endif /* end of include guard: OKAPI_SPSCQUEUE */
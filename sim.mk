@@ -0,0 +1,53 @@
+# Host build of the library against the simulated PAL (include/PAL/simPAL.h)
+# Produces $(BINDIR)/sim/$(LIBNAME)-sim.a for regression and tuning programs built with the host g++,
+# and the host tools in tools/ linked against it
+
+SIMDIR=$(BINDIR)/sim
+SIMCPPCC=g++
+SIMAR=ar
+SIMFLAGS:=-c -Wall -pedantic -Wextra -Wconversion -Wno-implicit-fallthrough -Wmissing-include-dirs -O2 -fsigned-char -fsingle-precision-constant -std=c++14 -fno-exceptions -fno-rtti -DDEBUG
+
+# Only library sources; the PROS entry points in src/ need the real kernel
+SIMSRC:=$(wildcard $(ROOT)/src/*/*.$(CPPEXT))
+SIMOBJ:=$(patsubst $(ROOT)/src/%.$(CPPEXT),$(SIMDIR)/%.o,$(SIMSRC))
+SIMHEADERS:=$(wildcard $(ROOT)/include/*/*.$(HEXT))
+
+.PHONY: sim odomreplay fixedpidbench odombench fastmathbench
+
+sim: $(SIMDIR)/$(LIBNAME)-sim.a
+
+odomreplay: $(SIMDIR)/odomReplay
+
+fixedpidbench: $(SIMDIR)/fixedPidBench
+	@$(SIMDIR)/fixedPidBench
+
+odombench: $(SIMDIR)/odomBench
+	@$(SIMDIR)/odomBench
+
+fastmathbench: $(SIMDIR)/fastMathBench
+	@$(SIMDIR)/fastMathBench
+
+$(SIMDIR)/$(LIBNAME)-sim.a: $(SIMOBJ)
+	@echo AR $@
+	@$(SIMAR) rcs $@ $^
+
+$(SIMOBJ): $(SIMDIR)/%.o: $(ROOT)/src/%.$(CPPEXT) $(SIMHEADERS)
+	@mkdir -p $(dir $@)
+	@echo SIMCPC $<
+	@$(SIMCPPCC) $(INCLUDE) $(SIMFLAGS) -o $@ $<
+
+$(SIMDIR)/odomReplay: $(ROOT)/tools/odomReplay.$(CPPEXT) $(SIMDIR)/$(LIBNAME)-sim.a
+	@echo SIMLD $@
+	@$(SIMCPPCC) $(INCLUDE) $(filter-out -c,$(SIMFLAGS)) -o $@ $^
+
+$(SIMDIR)/fixedPidBench: $(ROOT)/tools/fixedPidBench.$(CPPEXT) $(SIMDIR)/$(LIBNAME)-sim.a
+	@echo SIMLD $@
+	@$(SIMCPPCC) $(INCLUDE) $(filter-out -c,$(SIMFLAGS)) -o $@ $^
+
+$(SIMDIR)/odomBench: $(ROOT)/tools/odomBench.$(CPPEXT) $(SIMDIR)/$(LIBNAME)-sim.a
+	@echo SIMLD $@
+	@$(SIMCPPCC) $(INCLUDE) $(filter-out -c,$(SIMFLAGS)) -o $@ $^
+
+$(SIMDIR)/fastMathBench: $(ROOT)/tools/fastMathBench.$(CPPEXT) $(SIMDIR)/$(LIBNAME)-sim.a
+	@echo SIMLD $@
+	@$(SIMCPPCC) $(INCLUDE) $(filter-out -c,$(SIMFLAGS)) -o $@ $^
@@ -0,0 +1,690 @@
+#ifdef DEBUG
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <array>
+#include <memory>
+#include <vector>
+#include <ucontext.h>
+#include "PAL/PAL.h"
+
+struct SimFile {
+  std::FILE *host;
+};
+
+PROS_FILE simUart1{nullptr}, simUart2{nullptr};
+
+namespace okapi {
+  namespace {
+    constexpr std::size_t simStackSize = 256 * 1024; //Host frames are far larger than Cortex frames
+    constexpr std::size_t lcdWidth = 16;
+
+    struct SimTask {
+      ucontext_t context;
+      std::unique_ptr<char[]> stack;
+      TaskCode code;
+      void *params;
+      void (*loopFn)(void);
+      unsigned long loopIncrement;
+      unsigned int priority, state;
+      unsigned long long wakeTime, lastRun;
+    };
+
+    struct SimEncoder { int raw, offset; bool reversed; };
+    struct SimIME { int raw, offset, vel; };
+    struct SimGyro { int raw, offset; };
+    struct SimPin { bool level; unsigned char edges; InterruptHandler handler; };
+    struct SimMutex { SimTask *owner; };
+    struct SimSemaphore { bool available; };
+
+    struct SimState {
+      SimState():
+        now(0),
+        plantPeriod(1000),
+        mainTask(),
+        current(&mainTask),
+        runCount(0),
+        motors{},
+        analog{},
+        analogCalib{},
+        pins{},
+        encoders{},
+        gyros{},
+        ultrasonics{},
+        imes{},
+        imeCount(0),
+        joyAnalog{},
+        joyDigital{},
+        lcdButtons(0),
+        lcdText{},
+        enabled(false),
+        autonomous(false),
+        online(true),
+        mainBattery(7200),
+        backupBattery(0) {
+          mainTask.priority = TASK_PRIORITY_DEFAULT;
+          mainTask.state = TASK_RUNNING;
+        }
+
+      unsigned long long now;
+      std::function<void(const float)> plant;
+      unsigned long plantPeriod;
+
+      SimTask mainTask; //The harness, which runs on the host's own stack
+      std::vector<std::unique_ptr<SimTask>> tasks;
+      SimTask *current;
+      unsigned long long runCount;
+
+      std::array<int, 11> motors;
+      std::array<int, BOARD_NR_ADC_PINS + 1> analog, analogCalib;
+      std::array<SimPin, BOARD_NR_GPIO_PINS + 1> pins;
+      std::array<SimEncoder, BOARD_NR_GPIO_PINS + 1> encoders;
+      std::array<SimGyro, BOARD_NR_ADC_PINS + 1> gyros;
+      std::array<int, BOARD_NR_GPIO_PINS + 1> ultrasonics;
+      std::array<SimIME, IME_ADDR_MAX + 1> imes;
+      unsigned int imeCount;
+
+      std::array<std::array<int, 9>, 3> joyAnalog;
+      std::array<std::array<unsigned char, 9>, 3> joyDigital;
+      unsigned int lcdButtons;
+      std::array<std::array<char, lcdWidth + 1>, 4> lcdText;
+
+      bool enabled, autonomous, online;
+      unsigned int mainBattery, backupBattery;
+    };
+
+    //Constructed on first use so PAL calls from other static initializers are safe
+    SimState& sim() {
+      static SimState state;
+      return state;
+    }
+
+    void advanceClock(const unsigned long long itime) {
+      if (itime <= sim().now)
+        return;
+
+      if (sim().plant) {
+        while (sim().now < itime) {
+          const unsigned long long step = itime - sim().now < sim().plantPeriod ? itime - sim().now : sim().plantPeriod;
+          sim().now += step;
+          sim().plant(static_cast<float>(step) / 1000000.0f);
+        }
+      } else {
+        sim().now = itime;
+      }
+    }
+
+    bool isRunnable(const SimTask *itask) {
+      return itask->state != TASK_DEAD && itask->state != TASK_SUSPENDED;
+    }
+
+    //Earliest wake time first, then highest priority, then whoever ran least recently
+    SimTask* pickNext() {
+      SimTask *next = isRunnable(&sim().mainTask) ? &sim().mainTask : nullptr;
+
+      for (auto &task : sim().tasks) {
+        SimTask *t = task.get();
+        if (!isRunnable(t))
+          continue;
+
+        if (next == nullptr ||
+            t->wakeTime < next->wakeTime ||
+            (t->wakeTime == next->wakeTime && t->priority > next->priority) ||
+            (t->wakeTime == next->wakeTime && t->priority == next->priority && t->lastRun < next->lastRun))
+          next = t;
+      }
+
+      return next;
+    }
+
+    //Dead tasks are freed lazily because a task cannot free the stack it is running on
+    void reapTasks() {
+      for (auto it = sim().tasks.begin(); it != sim().tasks.end();) {
+        if ((*it)->state == TASK_DEAD && it->get() != sim().current)
+          it = sim().tasks.erase(it);
+        else
+          ++it;
+      }
+    }
+
+    void schedule() {
+      SimTask *prev = sim().current;
+      SimTask *next = pickNext();
+
+      if (next == nullptr) {
+        std::fprintf(stderr, "okapi sim: every task is suspended\n");
+        std::abort();
+      }
+
+      advanceClock(next->wakeTime);
+      next->lastRun = ++sim().runCount;
+      sim().current = next;
+
+      if (next != prev)
+        swapcontext(&prev->context, &next->context);
+
+      reapTasks();
+    }
+
+    void sleepUntil(const unsigned long long itime) {
+      sim().current->wakeTime = itime > sim().now ? itime : sim().now;
+      schedule();
+    }
+
+    void taskEntry() {
+      SimTask *self = sim().current;
+
+      if (self->loopFn != nullptr) {
+        unsigned long prevWakeTime = PAL::millis();
+        while (true) {
+          self->loopFn();
+          PAL::taskDelayUntil(&prevWakeTime, self->loopIncrement);
+        }
+      } else {
+        self->code(self->params);
+      }
+
+      self->state = TASK_DEAD;
+      schedule();
+    }
+
+    SimTask* newTask(const unsigned int ipriority) {
+      std::unique_ptr<SimTask> task(new SimTask());
+      task->stack.reset(new char[simStackSize]);
+      task->priority = ipriority < TASK_MAX_PRIORITIES ? ipriority : TASK_PRIORITY_HIGHEST;
+      task->state = TASK_RUNNABLE;
+      task->wakeTime = sim().now;
+      task->lastRun = 0;
+
+      getcontext(&task->context);
+      task->context.uc_stack.ss_sp = task->stack.get();
+      task->context.uc_stack.ss_size = simStackSize;
+      task->context.uc_link = nullptr;
+      makecontext(&task->context, taskEntry, 0);
+
+      SimTask *out = task.get();
+      sim().tasks.push_back(std::move(task));
+      return out;
+    }
+
+    //A new task which outranks its creator runs immediately, like under FreeRTOS
+    void startTask(SimTask *itask) {
+      if (itask->priority > sim().current->priority) {
+        sim().current->wakeTime = sim().now;
+        schedule();
+      }
+    }
+
+    SimTask* toTask(TaskHandle itask) {
+      return itask == nullptr ? sim().current : static_cast<SimTask*>(itask);
+    }
+
+    int lcdIndex(PROS_FILE *ilcdPort) {
+      return ilcdPort == uart2 ? 2 : 0;
+    }
+  }
+
+  void SimPAL::reset() {
+    if (sim().current != &sim().mainTask) {
+      std::fprintf(stderr, "okapi sim: reset called from a task\n");
+      std::abort();
+    }
+
+    sim().tasks.clear();
+    sim() = SimState();
+    sim().current = &sim().mainTask;
+  }
+
+  void SimPAL::run(const unsigned long ims) {
+    PAL::delay(ims);
+  }
+
+  unsigned long long SimPAL::getTime() {
+    return sim().now;
+  }
+
+  void SimPAL::setPlant(std::function<void(const float)> iplant, const unsigned long iperiod) {
+    sim().plant = iplant;
+    sim().plantPeriod = iperiod > 0 ? iperiod : 1;
+  }
+
+  void SimPAL::setEncoder(const unsigned char iportTop, const int ival) {
+    if (iportTop <= BOARD_NR_GPIO_PINS)
+      sim().encoders[iportTop].raw = ival;
+  }
+
+  void SimPAL::setIME(const unsigned char iaddress, const int ival, const int ivel) {
+    if (iaddress <= IME_ADDR_MAX) {
+      sim().imes[iaddress].raw = ival;
+      sim().imes[iaddress].vel = ivel;
+      if (iaddress >= sim().imeCount)
+        sim().imeCount = iaddress + 1u;
+    }
+  }
+
+  void SimPAL::setGyro(const unsigned char iport, const int ival) {
+    if (iport <= BOARD_NR_ADC_PINS)
+      sim().gyros[iport].raw = ival;
+  }
+
+  void SimPAL::setUltrasonic(const unsigned char iportEcho, const int ival) {
+    if (iportEcho <= BOARD_NR_GPIO_PINS)
+      sim().ultrasonics[iportEcho] = ival;
+  }
+
+  void SimPAL::setAnalog(const unsigned char ichannel, const int ival) {
+    if (ichannel <= BOARD_NR_ADC_PINS)
+      sim().analog[ichannel] = ival;
+  }
+
+  void SimPAL::setDigital(const unsigned char ipin, const bool ival) {
+    if (ipin > BOARD_NR_GPIO_PINS)
+      return;
+
+    SimPin &pin = sim().pins[ipin];
+    const bool old = pin.level;
+    pin.level = ival;
+
+    if (pin.handler != nullptr && old != ival) {
+      if ((ival && (pin.edges & INTERRUPT_EDGE_RISING)) || (!ival && (pin.edges & INTERRUPT_EDGE_FALLING)))
+        pin.handler(ipin);
+    }
+  }
+
+  void SimPAL::setJoystickAnalog(const unsigned char ijoystick, const unsigned char iaxis, const int ival) {
+    if (ijoystick >= 1 && ijoystick <= 2 && iaxis <= 8)
+      sim().joyAnalog[ijoystick][iaxis] = ival;
+  }
+
+  void SimPAL::setJoystickDigital(const unsigned char ijoystick, const unsigned char ibuttonGroup, const unsigned char ibutton, const bool ival) {
+    if (ijoystick >= 1 && ijoystick <= 2 && ibuttonGroup <= 8) {
+      unsigned char &group = sim().joyDigital[ijoystick][ibuttonGroup];
+      group = static_cast<unsigned char>(ival ? (group | ibutton) : (group & ~ibutton));
+    }
+  }
+
+  void SimPAL::setLCDButtons(const unsigned int ival) {
+    sim().lcdButtons = ival;
+  }
+
+  const char* SimPAL::getLCDText(PROS_FILE *ilcdPort, const unsigned char iline) {
+    return sim().lcdText[static_cast<std::size_t>(lcdIndex(ilcdPort) + (iline == 2 ? 1 : 0))].data();
+  }
+
+  void SimPAL::setCompetitionState(const bool iisEnabled, const bool iisAutonomous, const bool iisOnline) {
+    sim().enabled = iisEnabled;
+    sim().autonomous = iisAutonomous;
+    sim().online = iisOnline;
+  }
+
+  void SimPAL::setBatteryLevels(const unsigned int imain, const unsigned int ibackup) {
+    sim().mainBattery = imain;
+    sim().backupBattery = ibackup;
+  }
+
+  //Competition
+  bool PAL::isAutonomous() { return sim().autonomous; }
+  bool PAL::isEnabled() { return sim().enabled; }
+  bool PAL::isJoystickConnected(unsigned char joystick) { return joystick >= 1 && joystick <= 2 && sim().online; }
+  bool PAL::isOnline() { return sim().online; }
+
+  int PAL::joystickGetAnalog(unsigned char joystick, unsigned char axis) {
+    return joystick >= 1 && joystick <= 2 && axis <= 8 ? sim().joyAnalog[joystick][axis] : 0;
+  }
+
+  bool PAL::joystickGetDigital(unsigned char joystick, unsigned char buttonGroup, unsigned char button) {
+    return joystick >= 1 && joystick <= 2 && buttonGroup <= 8 && (sim().joyDigital[joystick][buttonGroup] & button) != 0;
+  }
+
+  unsigned int PAL::powerLevelBackup() { return sim().backupBattery; }
+  unsigned int PAL::powerLevelMain() { return sim().mainBattery; }
+  void PAL::setTeamName(const char *) {}
+
+  //Analog and digital IO
+  int PAL::analogCalibrate(unsigned char channel) {
+    if (channel > BOARD_NR_ADC_PINS)
+      return 0;
+    sim().analogCalib[channel] = sim().analog[channel];
+    return sim().analogCalib[channel];
+  }
+
+  int PAL::analogRead(unsigned char channel) {
+    return channel <= BOARD_NR_ADC_PINS ? sim().analog[channel] : 0;
+  }
+
+  int PAL::analogReadCalibrated(unsigned char channel) {
+    return channel <= BOARD_NR_ADC_PINS ? sim().analog[channel] - sim().analogCalib[channel] : 0;
+  }
+
+  int PAL::analogReadCalibratedHR(unsigned char channel) {
+    return analogReadCalibrated(channel) * 16;
+  }
+
+  bool PAL::digitalRead(unsigned char pin) {
+    return pin <= BOARD_NR_GPIO_PINS ? sim().pins[pin].level : false;
+  }
+
+  void PAL::digitalWrite(unsigned char pin, bool value) {
+    if (pin <= BOARD_NR_GPIO_PINS)
+      sim().pins[pin].level = value;
+  }
+
+  void PAL::pinMode(unsigned char, unsigned char) {}
+
+  void PAL::ioClearInterrupt(unsigned char pin) {
+    if (pin <= BOARD_NR_GPIO_PINS)
+      sim().pins[pin].handler = nullptr;
+  }
+
+  void PAL::ioSetInterrupt(unsigned char pin, unsigned char edges, InterruptHandler handler) {
+    if (pin <= BOARD_NR_GPIO_PINS) {
+      sim().pins[pin].edges = edges;
+      sim().pins[pin].handler = handler;
+    }
+  }
+
+  //Motors
+  int PAL::motorGet(unsigned char channel) {
+    return channel >= 1 && channel <= 10 ? sim().motors[channel] : 0;
+  }
+
+  void PAL::motorSet(unsigned char channel, int speed) {
+    if (channel >= 1 && channel <= 10)
+      sim().motors[channel] = speed > 127 ? 127 : (speed < -127 ? -127 : speed);
+  }
+
+  void PAL::motorStop(unsigned char channel) { motorSet(channel, 0); }
+
+  void PAL::motorStopAll() {
+    for (auto &motor : sim().motors)
+      motor = 0;
+  }
+
+  //Speaker
+  void PAL::speakerInit() {}
+  void PAL::speakerPlayArray(const char * *) {}
+  void PAL::speakerPlayRtttl(const char *) {}
+  void PAL::speakerShutdown() {}
+
+  //Sensors
+  unsigned int PAL::imeInitializeAll() { return sim().imeCount; }
+
+  bool PAL::imeGet(unsigned char address, int *value) {
+    if (address >= sim().imeCount)
+      return false;
+    *value = sim().imes[address].raw - sim().imes[address].offset;
+    return true;
+  }
+
+  bool PAL::imeGetVelocity(unsigned char address, int *value) {
+    if (address >= sim().imeCount)
+      return false;
+    *value = sim().imes[address].vel;
+    return true;
+  }
+
+  bool PAL::imeReset(unsigned char address) {
+    if (address >= sim().imeCount)
+      return false;
+    sim().imes[address].offset = sim().imes[address].raw;
+    return true;
+  }
+
+  void PAL::imeShutdown() {}
+
+  int PAL::gyroGet(Gyro gyro) {
+    const SimGyro *g = static_cast<SimGyro*>(gyro);
+    return g == nullptr ? 0 : g->raw - g->offset;
+  }
+
+  Gyro PAL::gyroInit(unsigned char port, unsigned short) {
+    if (port < 1 || port > BOARD_NR_ADC_PINS)
+      return nullptr;
+    sim().gyros[port].offset = sim().gyros[port].raw;
+    return &sim().gyros[port];
+  }
+
+  void PAL::gyroReset(Gyro gyro) {
+    SimGyro *g = static_cast<SimGyro*>(gyro);
+    if (g != nullptr)
+      g->offset = g->raw;
+  }
+
+  void PAL::gyroShutdown(Gyro) {}
+
+  int PAL::encoderGet(Encoder enc) {
+    const SimEncoder *e = static_cast<SimEncoder*>(enc);
+    return e == nullptr ? 0 : (e->reversed ? e->offset - e->raw : e->raw - e->offset);
+  }
+
+  Encoder PAL::encoderInit(unsigned char portTop, unsigned char, bool reverse) {
+    if (portTop < 1 || portTop > BOARD_NR_GPIO_PINS)
+      return nullptr;
+    SimEncoder &e = sim().encoders[portTop];
+    e.offset = e.raw;
+    e.reversed = reverse;
+    return &e;
+  }
+
+  void PAL::encoderReset(Encoder enc) {
+    SimEncoder *e = static_cast<SimEncoder*>(enc);
+    if (e != nullptr)
+      e->offset = e->raw;
+  }
+
+  void PAL::encoderShutdown(Encoder) {}
+
+  int PAL::ultrasonicGet(Ultrasonic ult) {
+    return ult == nullptr ? ULTRA_BAD_RESPONSE : *static_cast<int*>(ult);
+  }
+
+  Ultrasonic PAL::ultrasonicInit(unsigned char portEcho, unsigned char) {
+    return portEcho >= 1 && portEcho <= BOARD_NR_GPIO_PINS ? &sim().ultrasonics[portEcho] : nullptr;
+  }
+
+  void PAL::ultrasonicShutdown(Ultrasonic) {}
+
+  //There are no simulated I2C devices other than the IMEs
+  bool PAL::i2cRead(uint8_t, uint8_t *, uint16_t) { return false; }
+  bool PAL::i2cReadRegister(uint8_t, uint8_t, uint8_t *, uint16_t) { return false; }
+  bool PAL::i2cWrite(uint8_t, uint8_t *, uint16_t) { return false; }
+  bool PAL::i2cWriteRegister(uint8_t, uint8_t, uint16_t) { return false; }
+
+  //Files and serial. The UARTs discard output; flash files are host files
+  void PAL::usartInit(PROS_FILE *, unsigned int, unsigned int) {}
+  void PAL::usartShutdown(PROS_FILE *) {}
+
+  void PAL::fclose(PROS_FILE *stream) {
+    if (stream == uart1 || stream == uart2)
+      return;
+    std::fclose(stream->host);
+    delete stream;
+  }
+
+  int PAL::fcount(PROS_FILE *stream) {
+    if (stream->host == nullptr)
+      return 0;
+    const long pos = std::ftell(stream->host);
+    std::fseek(stream->host, 0, SEEK_END);
+    const long end = std::ftell(stream->host);
+    std::fseek(stream->host, pos, SEEK_SET);
+    return static_cast<int>(end - pos);
+  }
+
+  int PAL::fdelete(const char *file) { return std::remove(file); }
+  int PAL::feof(PROS_FILE *stream) { return stream->host == nullptr ? 1 : std::feof(stream->host); }
+  int PAL::fflush(PROS_FILE *stream) { return stream->host == nullptr ? 0 : std::fflush(stream->host); }
+  int PAL::fgetc(PROS_FILE *stream) { return stream->host == nullptr ? EOF : std::fgetc(stream->host); }
+  char* PAL::fgets(char *str, int num, PROS_FILE *stream) { return stream->host == nullptr ? nullptr : std::fgets(str, num, stream->host); }
+
+  PROS_FILE* PAL::fopen(const char *file, const char *mode) {
+    std::FILE *host = std::fopen(file, mode);
+    return host == nullptr ? nullptr : new SimFile{host};
+  }
+
+  void PAL::fprint(const char *string, PROS_FILE *stream) { fputs(string, stream); }
+  int PAL::fputc(int value, PROS_FILE *stream) { return stream->host == nullptr ? value : std::fputc(value, stream->host); }
+  int PAL::fputs(const char *string, PROS_FILE *stream) { return stream->host == nullptr ? 0 : std::fputs(string, stream->host); }
+  size_t PAL::fread(void *ptr, size_t size, size_t count, PROS_FILE *stream) { return stream->host == nullptr ? 0 : std::fread(ptr, size, count, stream->host); }
+  int PAL::fseek(PROS_FILE *stream, long int offset, int origin) { return stream->host == nullptr ? -1 : std::fseek(stream->host, offset, origin); }
+  long int PAL::ftell(PROS_FILE *stream) { return stream->host == nullptr ? -1 : std::ftell(stream->host); }
+  size_t PAL::fwrite(const void *ptr, size_t size, size_t count, PROS_FILE *stream) { return stream->host == nullptr ? count : std::fwrite(ptr, size, count, stream->host); }
+  int PAL::getchar() { return std::getchar(); }
+  void PAL::print(const char *string) { std::fputs(string, stdout); }
+  int PAL::putchar(int value) { return std::putchar(value); }
+  int PAL::puts(const char *string) { return std::puts(string); }
+
+  //LCD
+  void PAL::lcdClear(PROS_FILE *lcdPort) {
+    lcdSetText(lcdPort, 1, "");
+    lcdSetText(lcdPort, 2, "");
+  }
+
+  void PAL::lcdInit(PROS_FILE *) {}
+  unsigned int PAL::lcdReadButtons(PROS_FILE *) { return sim().lcdButtons; }
+  void PAL::lcdSetBacklight(PROS_FILE *, bool) {}
+
+  void PAL::lcdSetText(PROS_FILE *lcdPort, unsigned char line, const char *buffer) {
+    auto &text = sim().lcdText[static_cast<std::size_t>(lcdIndex(lcdPort) + (line == 2 ? 1 : 0))];
+    std::strncpy(text.data(), buffer, lcdWidth);
+    text[lcdWidth] = '\0';
+  }
+
+  void PAL::lcdShutdown(PROS_FILE *) {}
+
+  //Tasks
+  TaskHandle PAL::taskCreate(TaskCode taskCode, const unsigned int, void *parameters, const unsigned int priority) {
+    SimTask *task = newTask(priority);
+    task->code = taskCode;
+    task->params = parameters;
+    startTask(task);
+    return task;
+  }
+
+  void PAL::taskDelay(const unsigned long msToDelay) {
+    sleepUntil(sim().now + msToDelay * 1000ull);
+  }
+
+  void PAL::taskDelayUntil(unsigned long *previousWakeTime, const unsigned long cycleTime) {
+    *previousWakeTime += cycleTime;
+    sleepUntil(*previousWakeTime * 1000ull);
+  }
+
+  void PAL::taskDelete(TaskHandle taskToDelete) {
+    SimTask *task = toTask(taskToDelete);
+    if (task == &sim().mainTask)
+      return;
+
+    task->state = TASK_DEAD;
+    if (task == sim().current)
+      schedule();
+    else
+      reapTasks();
+  }
+
+  unsigned int PAL::taskGetCount() {
+    unsigned int count = 1;
+    for (auto &task : sim().tasks)
+      if (task->state != TASK_DEAD)
+        count++;
+    return count;
+  }
+
+  unsigned int PAL::taskGetState(TaskHandle task) {
+    const SimTask *t = toTask(task);
+    if (t == sim().current)
+      return TASK_RUNNING;
+    if (t->state == TASK_DEAD || t->state == TASK_SUSPENDED)
+      return t->state;
+    return t->wakeTime > sim().now ? TASK_SLEEPING : TASK_RUNNABLE;
+  }
+
+  unsigned int PAL::taskPriorityGet(const TaskHandle task) { return toTask(task)->priority; }
+
+  void PAL::taskPrioritySet(TaskHandle task, const unsigned int newPriority) {
+    toTask(task)->priority = newPriority < TASK_MAX_PRIORITIES ? newPriority : TASK_PRIORITY_HIGHEST;
+  }
+
+  void PAL::taskResume(TaskHandle taskToResume) {
+    SimTask *task = toTask(taskToResume);
+    if (task->state == TASK_SUSPENDED) {
+      task->state = TASK_RUNNABLE;
+      task->wakeTime = sim().now;
+    }
+  }
+
+  TaskHandle PAL::taskRunLoop(void (*fn)(void), const unsigned long increment) {
+    SimTask *task = newTask(TASK_PRIORITY_DEFAULT);
+    task->loopFn = fn;
+    task->loopIncrement = increment;
+    startTask(task);
+    return task;
+  }
+
+  void PAL::taskSuspend(TaskHandle taskToSuspend) {
+    SimTask *task = toTask(taskToSuspend);
+    task->state = TASK_SUSPENDED;
+    if (task == sim().current)
+      schedule();
+  }
+
+  //Synchronization. Blocking polls once per ms of virtual time
+  Semaphore PAL::semaphoreCreate() { return new SimSemaphore{true}; }
+
+  bool PAL::semaphoreGive(Semaphore semaphore) {
+    static_cast<SimSemaphore*>(semaphore)->available = true;
+    return true;
+  }
+
+  bool PAL::semaphoreTake(Semaphore semaphore, const unsigned long blockTime) {
+    SimSemaphore *sem = static_cast<SimSemaphore*>(semaphore);
+    const unsigned long start = millis();
+    while (!sem->available) {
+      if (blockTime != maxDelay && millis() - start >= blockTime)
+        return false;
+      taskDelay(1);
+    }
+    sem->available = false;
+    return true;
+  }
+
+  void PAL::semaphoreDelete(Semaphore semaphore) { delete static_cast<SimSemaphore*>(semaphore); }
+
+  Mutex PAL::mutexCreate() { return new SimMutex{nullptr}; }
+
+  bool PAL::mutexGive(Mutex mutex) {
+    SimMutex *m = static_cast<SimMutex*>(mutex);
+    if (m->owner != sim().current)
+      return false;
+    m->owner = nullptr;
+    return true;
+  }
+
+  //Not recursive, like the PROS mutex: a second take by the owner blocks until blockTime runs out
+  bool PAL::mutexTake(Mutex mutex, const unsigned long blockTime) {
+    SimMutex *m = static_cast<SimMutex*>(mutex);
+    const unsigned long start = millis();
+    while (m->owner != nullptr) {
+      if (blockTime != maxDelay && millis() - start >= blockTime)
+        return false;
+      taskDelay(1);
+    }
+    m->owner = sim().current;
+    return true;
+  }
+
+  void PAL::mutexDelete(Mutex mutex) { delete static_cast<SimMutex*>(mutex); }
+
+  //Time
+  void PAL::delay(const unsigned long time) { taskDelay(time); }
+  void PAL::delayMicroseconds(const unsigned long us) { sleepUntil(sim().now + us); }
+  unsigned long PAL::micros() { return static_cast<unsigned long>(sim().now); }
+  unsigned long PAL::millis() { return static_cast<unsigned long>(sim().now / 1000); }
+  void PAL::wait(const unsigned long time) { taskDelay(time); }
+  void PAL::waitUntil(unsigned long *previousWakeTime, const unsigned long time) { taskDelayUntil(previousWakeTime, time); }
+  void PAL::watchdogInit() {}
+  void PAL::standaloneModeEnable() {}
+}
+
+#endif
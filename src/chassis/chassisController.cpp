@@ -4,103 +4,237 @@
 #include <cmath>
 
 namespace okapi {
-  void ChassisControllerPid::driveStraight(const int itarget) {
-    using namespace std;
-
-    const auto encStartVals = model->getSensorVals();
-    float distanceElapsed = 0, angleChange = 0, lastDistance = 0;
-    unsigned long prevWakeTime = PAL::millis();
+  bool AsyncMotion::isSettled() const {
+    return controller->isSettled(id);
+  }
 
-    distancePid.reset();
-    anglePid.reset();
-    distancePid.setTarget(static_cast<float>(itarget));
-    anglePid.setTarget(0);
+  bool AsyncMotion::waitUntilSettled(const unsigned long itimeout) const {
+    return controller->waitUntilSettled(id, itimeout);
+  }
 
-    bool atTarget = false;
-    const int atTargetDistance = 15;
-    const int threshold = 2;
+  void AsyncMotion::cancel() {
+    controller->cancel(id);
+  }
 
-    Timer atTargetTimer;
+  void ChassisControllerPid::driveStraight(const int itarget) {
+    driveStraightAsync(itarget).waitUntilSettled();
+  }
 
-    const int timeoutPeriod = 250;
+  void ChassisControllerPid::pointTurn(float idegTarget) {
+    pointTurnAsync(idegTarget).waitUntilSettled();
+  }
 
-    valarray<int> encVals{0, 0};
-    float distOutput, angleOutput;
+  AsyncMotion ChassisControllerPid::driveStraightAsync(const int itarget) {
+    return startMotion(MotionMode::distance, static_cast<float>(itarget));
+  }
 
+  AsyncMotion ChassisControllerPid::pointTurnAsync(float idegTarget) {
+    return startMotion(MotionMode::angle, idegTarget);
+  }
 
-    while (!atTarget) {
-      encVals = model->getSensorVals() - encStartVals;
-      distanceElapsed = static_cast<float>((encVals[0] + encVals[1])) / 2.0;
-      angleChange = static_cast<float>(encVals[1] - encVals[0]);
+  ChassisControllerPid::~ChassisControllerPid() {
+    deleteMotionTask();
+  }
 
-      distOutput = distancePid.step(distanceElapsed);
-      angleOutput = anglePid.step(angleChange);
-      model->driveVector(static_cast<int>(distOutput), static_cast<int>(angleOutput));
+  void ChassisControllerPid::deleteMotionTask() {
+    if (motionTask == nullptr)
+      return;
 
-      if (abs(itarget - static_cast<int>(distanceElapsed)) <= atTargetDistance)
-        atTargetTimer.placeHardMark();
-      else if (abs(static_cast<int>(distanceElapsed) - static_cast<int>(lastDistance)) <= threshold)
-        atTargetTimer.placeHardMark();
-      else
-        atTargetTimer.clearHardMark();
+    //Holding the mutex means the task is between steps, so it is not deleted while holding it
+    PAL::mutexTake(motionMutex, maxDelay);
+    PAL::taskDelete(motionTask);
+    motionTask = nullptr;
 
-      lastDistance = distanceElapsed;
+    if (mode != MotionMode::none) {
+      model->driveForward(0);
+      mode = MotionMode::none;
+    }
 
-      if (atTargetTimer.getDtFromHardMark() >= timeoutPeriod)
-        atTarget = true;
+    PAL::mutexGive(motionMutex);
+    PAL::mutexDelete(motionMutex);
+    motionMutex = nullptr;
+  }
 
-      PAL::taskDelayUntil(&prevWakeTime, 15);
+  void ChassisControllerPid::ensureMotionTask() {
+    if (motionTask == nullptr) {
+      motionMutex = PAL::mutexCreate();
+      motionTask = PAL::taskCreate((TaskCode)ChassisControllerPid::trampoline, TASK_DEFAULT_STACK_SIZE, this, TASK_PRIORITY_DEFAULT + 1);
     }
+  }
+
+  AsyncMotion ChassisControllerPid::startMotion(const MotionMode imode, const float itarget, const MotionMode inextMode, const float inextTarget) {
+    ensureMotionTask();
 
-    model->driveForward(0);
+    PAL::mutexTake(motionMutex, maxDelay);
+    const AsyncMotion motion = startMotionLocked(imode, itarget, inextMode, inextTarget);
+    PAL::mutexGive(motionMutex);
+
+    return motion;
   }
 
-  void ChassisControllerPid::pointTurn(float idegTarget) {
-    using namespace std;
-    
-    const auto encStartVals = model->getSensorVals();
-    float angleChange = 0, lastAngle = 0;
-    unsigned long prevWakeTime = PAL::millis();
+  AsyncMotion ChassisControllerPid::startMotionLocked(const MotionMode imode, const float itarget, const MotionMode inextMode, const float inextTarget) {
+    mode = imode;
+    motionTarget = itarget;
+    nextMode = inextMode;
+    nextTarget = inextTarget;
+    beginMotion();
 
-    while (idegTarget > 180)
-      idegTarget -= 360;
-    while (idegTarget <= -180)
-      idegTarget += 360;
+    //The motion this replaces is over
+    const std::uint32_t id = motionId.load() + 1;
+    settledId.store(id - 1);
+    motionId.store(id);
 
-    anglePid.reset();
-    anglePid.setTarget(static_cast<float>(idegTarget));
+    return AsyncMotion(*this, id);
+  }
 
-    bool atTarget = false;
-    const int atTargetAngle = 10;
-    const int threshold = 2;
+  void ChassisControllerPid::beginMotion() {
+    encStartVals = model->getSensorVals();
+    lastValue = 0;
+    atTargetTimer.clearHardMark();
+
+    if (mode == MotionMode::distance) {
+      distancePid.reset();
+      anglePid.reset();
+      anglePid.setTarget(0);
+
+      if (isProfiled) {
+        distanceProfile.generate(motionTarget);
+        distancePid.setTarget(0);
+        profileStart = PAL::millis();
+      } else {
+        distancePid.setTarget(motionTarget);
+      }
+    } else if (mode == MotionMode::angle) {
+      while (motionTarget > 180)
+        motionTarget -= 360;
+      while (motionTarget <= -180)
+        motionTarget += 360;
+
+      anglePid.reset();
+      anglePid.setTarget(motionTarget);
+    }
+  }
 
-    Timer atTargetTimer;
+  bool ChassisControllerPid::motionStep() {
+    using namespace std;
 
+    const int threshold = 2;
     const int timeoutPeriod = 250;
 
-    valarray<int> encVals{0, 0};
+    const auto encVals = model->getSensorVals();
+    const int leftElapsed = encVals[0] - encStartVals[0];
+    const int rightElapsed = encVals[1] - encStartVals[1];
+    const float angleChange = static_cast<float>(leftElapsed - rightElapsed); //Clockwise positive to match turnClockwise and driveVector
+
+    if (mode == MotionMode::distance) {
+      const int atTargetDistance = 15;
+      const float distanceElapsed = static_cast<float>((leftElapsed + rightElapsed)) / 2.0;
+
+      float feedforward = 0;
+      bool isProfileDone = true;
+      if (isProfiled) {
+        const float time = static_cast<float>(PAL::millis() - profileStart) / 1000.0;
+        const MotionSetpoint setpoint = distanceProfile.get(time);
+        distancePid.setTarget(setpoint.position);
+        feedforward = profileFeedforward.calculate(setpoint.velocity, setpoint.acceleration);
+        isProfileDone = time >= distanceProfile.getDuration();
+      }
+
+      const float distOutput = distancePid.step(distanceElapsed) + feedforward;
+      const float angleOutput = holdAngle(angleChange);
+      model->driveVector(static_cast<int>(distOutput), static_cast<int>(angleOutput));
+
+      if (!isProfileDone)
+        atTargetTimer.clearHardMark(); //The robot is meant to be moving slowly at the ends of the profile
+      else if (abs(static_cast<int>(motionTarget) - static_cast<int>(distanceElapsed)) <= atTargetDistance)
+        atTargetTimer.placeHardMark();
+      else if (abs(static_cast<int>(distanceElapsed) - static_cast<int>(lastValue)) <= threshold)
+        atTargetTimer.placeHardMark();
+      else
+        atTargetTimer.clearHardMark();
 
-    while (!atTarget) {
-      encVals = model->getSensorVals() - encStartVals;
-      angleChange = static_cast<float>(encVals[1] - encVals[0]);
+      lastValue = distanceElapsed;
+    } else {
+      const int atTargetAngle = 10;
 
       model->turnClockwise(static_cast<int>(anglePid.step(angleChange)));
 
-      if (fabs(idegTarget - angleChange) <= atTargetAngle)
+      if (fabs(motionTarget - angleChange) <= atTargetAngle)
         atTargetTimer.placeHardMark();
-      else if (fabs(angleChange - lastAngle) <= threshold)
+      else if (fabs(angleChange - lastValue) <= threshold)
         atTargetTimer.placeHardMark();
       else
         atTargetTimer.clearHardMark();
 
-      lastAngle = angleChange;
+      lastValue = angleChange;
+    }
+
+    return atTargetTimer.getDtFromHardMark() >= timeoutPeriod;
+  }
+
+  void ChassisControllerPid::setDistanceProfile(const MotionProfileParams& iparams, const float ikV, const float ikA, const float ikS) {
+    if (motionMutex != nullptr)
+      PAL::mutexTake(motionMutex, maxDelay);
+
+    distanceProfile.setParams(iparams);
+    isProfiled = iparams.maxVel > 0 && iparams.maxAccel > 0;
+    profileFeedforward = VelFeedforward(ikS, ikV, ikA);
+
+    if (motionMutex != nullptr)
+      PAL::mutexGive(motionMutex);
+  }
+
+  void ChassisControllerPid::loop() {
+    unsigned long prevWakeTime = PAL::millis();
+
+    while (true) {
+      PAL::mutexTake(motionMutex, maxDelay);
 
-      if (atTargetTimer.getDtFromHardMark() >= timeoutPeriod)
-        atTarget = true;
+      if (mode != MotionMode::none && motionStep()) {
+        if (nextMode != MotionMode::none) {
+          mode = nextMode;
+          motionTarget = nextTarget;
+          nextMode = MotionMode::none;
+          beginMotion();
+        } else {
+          model->driveForward(0);
+          mode = MotionMode::none;
+          settledId.store(motionId.load());
+        }
+      }
+
+      PAL::mutexGive(motionMutex);
 
       PAL::taskDelayUntil(&prevWakeTime, 15);
     }
+  }
+
+  bool ChassisControllerPid::waitUntilSettled(const std::uint32_t iid, const unsigned long itimeout) const {
+    const unsigned long start = PAL::millis();
+
+    while (!isSettled(iid)) {
+      if (PAL::millis() - start >= itimeout)
+        return false;
+
+      PAL::taskDelay(5);
+    }
+
+    return true;
+  }
+
+  void ChassisControllerPid::cancel(const std::uint32_t iid) {
+    if (motionTask == nullptr)
+      return;
+
+    PAL::mutexTake(motionMutex, maxDelay);
+
+    if (motionId.load() == iid && !isSettled(iid)) {
+      mode = MotionMode::none;
+      nextMode = MotionMode::none;
+      model->driveForward(0);
+      settledId.store(iid);
+    }
 
-    model->driveForward(0);
+    PAL::mutexGive(motionMutex);
   }
 }
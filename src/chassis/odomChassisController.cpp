@@ -3,24 +3,139 @@
 #include <cmath>
 
 namespace okapi {
+  constexpr float OdomChassisControllerPid::maxHeldHeadingError;
+
   void OdomChassisControllerPid::driveToPoint(const float ix, const float iy, const bool ibackwards, const float ioffset) {
-    DistanceAndAngle daa = OdomMath::computeDistanceAndAngleToPoint(ix, iy, odom.getState());
+    driveToPointAsync(ix, iy, ibackwards, ioffset).waitUntilSettled();
+  }
+
+  void OdomChassisControllerPid::turnToAngle(const float iangle) {
+    turnToAngleAsync(iangle).waitUntilSettled();
+  }
+
+  AsyncMotion OdomChassisControllerPid::driveToPointAsync(const float ix, const float iy, const bool ibackwards, const float ioffset) {
+    const OdomState state = odom.getState();
+    float heading = OdomMath::computeAngleToPoint(ix, iy, state) + state.theta;
+    float length = OdomMath::computeDistanceToPoint(ix, iy, state);
 
     if (ibackwards) {
-      daa.theta += 180;
-      daa.length *= -1;
+      heading += 180;
+      length *= -1;
     }
 
-    if (std::abs(daa.theta) > 1) {
-      ChassisControllerPid::pointTurn(daa.theta);
+    const bool shouldTurn = std::fabs(headingError(heading)) > 1;
+    const bool shouldDrive = std::fabs(length - ioffset) > moveThreshold;
+    const float distance = static_cast<float>(static_cast<int>(length - ioffset));
+
+    if (shouldTurn && shouldDrive)
+      return startHeldMotion(heading, MotionMode::heading, heading, MotionMode::distance, distance);
+    else if (shouldTurn)
+      return startHeldMotion(heading, MotionMode::heading, heading);
+    else if (shouldDrive)
+      return startHeldMotion(heading, MotionMode::distance, distance);
+
+    return AsyncMotion(*this, settledId.load()); //Already there, so hand back a motion which is over
+  }
+
+  AsyncMotion OdomChassisControllerPid::turnToAngleAsync(const float iangle) {
+    return startHeldMotion(iangle, MotionMode::heading, iangle);
+  }
+
+  AsyncMotion OdomChassisControllerPid::startHeldMotion(const float iheading, const MotionMode imode, const float itarget, const MotionMode inextMode, const float inextTarget) {
+    ensureMotionTask();
+
+    PAL::mutexTake(motionMutex, maxDelay);
+    heldHeading = iheading;
+    hasHeldHeading = true;
+    const AsyncMotion motion = startMotionLocked(imode, itarget, inextMode, inextTarget);
+    PAL::mutexGive(motionMutex);
+
+    return motion;
+  }
+
+  float OdomChassisControllerPid::headingError(const float iheading) const {
+    float error = iheading - odom.getState().theta;
+    while (error > 180)
+      error -= 360;
+    while (error <= -180)
+      error += 360;
+    return error;
+  }
+
+  bool OdomChassisControllerPid::followPath(std::initializer_list<Waypoint> iwaypoints, const unsigned long itimeout) {
+    AsyncMotion motion = followPathAsync(iwaypoints);
+    if (motion.waitUntilSettled(itimeout))
+      return true;
+
+    motion.cancel();
+    return false;
+  }
+
+  AsyncMotion OdomChassisControllerPid::followPathAsync(std::initializer_list<Waypoint> iwaypoints) {
+    ensureMotionTask();
+
+    PAL::mutexTake(motionMutex, maxDelay);
+    pursuit.setParams(pathParams);
+    pursuit.setPath(odom.getState(), iwaypoints);
+    const AsyncMotion motion = startMotionLocked(MotionMode::path, 0);
+    PAL::mutexGive(motionMutex);
+
+    return motion;
+  }
+
+  void OdomChassisControllerPid::beginMotion() {
+    ChassisControllerPid::beginMotion();
+
+    if (mode == MotionMode::heading) {
+      heldHeading = motionTarget;
+      hasHeldHeading = true;
+    } else if (mode == MotionMode::distance) {
+      //Holding the commanded heading instead of the current one keeps small misses from adding
+      //up over chained motions, unless the robot has been moved well off it since
+      if (!hasHeldHeading || std::fabs(headingError(heldHeading)) > maxHeldHeadingError)
+        heldHeading = odom.getState().theta;
+      hasHeldHeading = true;
+    } else {
+      hasHeldHeading = false; //Relative turns and paths end facing wherever they end
     }
 
-    if (std::abs(daa.length - ioffset) > moveThreshold) {
-      ChassisControllerPid::driveStraight(static_cast<int>(daa.length - ioffset));
+    headingPid.reset();
+    headingPid.setTarget(0);
+  }
+
+  bool OdomChassisControllerPid::motionStep() {
+    if (mode == MotionMode::heading) {
+      const float atTargetAngle = 2;
+      const float threshold = 0.2;
+      const int timeoutPeriod = 250;
+
+      //The reading is the error toward the target, so the output is clockwise power
+      const float error = headingError(motionTarget);
+      model->turnClockwise(static_cast<int>(headingPid.step(error)));
+
+      if (std::fabs(error) <= atTargetAngle)
+        atTargetTimer.placeHardMark();
+      else if (std::fabs(error - lastValue) <= threshold)
+        atTargetTimer.placeHardMark();
+      else
+        atTargetTimer.clearHardMark();
+
+      lastValue = error;
+      return atTargetTimer.getDtFromHardMark() >= timeoutPeriod;
     }
+
+    if (mode != MotionMode::path)
+      return ChassisControllerPid::motionStep();
+
+    const PurePursuitOutput out = pursuit.step(odom.getState());
+    model->driveVector(static_cast<int>(out.distPower), static_cast<int>(out.anglePower));
+    return out.isDone;
   }
 
-  void OdomChassisControllerPid::turnToAngle(const float iangle) {
-    ChassisControllerPid::pointTurn(iangle - odom.getState().theta);
+  float OdomChassisControllerPid::holdAngle(const float iangleChange) {
+    if (!hasHeldHeading)
+      return ChassisControllerPid::holdAngle(iangleChange);
+
+    return headingPid.step(headingError(heldHeading));
   }
 }
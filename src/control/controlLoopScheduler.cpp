@@ -0,0 +1,102 @@
+#include "control/controlLoopScheduler.h"
+
+namespace okapi {
+  constexpr std::size_t ControlLoopScheduler::maxLoops;
+
+  int ControlLoopScheduler::add(std::function<void(const float)> iloop, const unsigned long iperiod) {
+    if (isStarted || count >= maxLoops || iperiod == 0)
+      return -1;
+
+    Entry& entry = loops[count];
+    entry.loop = iloop;
+    entry.period = iperiod;
+
+    //Insert into the run order, keeping it sorted by period (ties keep registration order)
+    std::size_t i = count;
+    while (i > 0 && loops[order[i - 1]].period > entry.period) {
+      order[i] = order[i - 1];
+      i--;
+    }
+    order[i] = count;
+
+    return static_cast<int>(count++);
+  }
+
+  int ControlLoopScheduler::add(ControlObject& icontroller, std::function<float()> ireading, std::function<void(const float)> ioutput, const unsigned long iperiod) {
+    icontroller.setSampleTime(static_cast<int>(iperiod)); //So the gains are scaled for the nominal time step
+    return add([&icontroller, ireading, ioutput](const float idt) { ioutput(icontroller.stepDt(ireading(), idt)); }, iperiod);
+  }
+
+  int ControlLoopScheduler::add(Odometry& iodom, const unsigned long iperiod) {
+    return add([&iodom](const float) { iodom.step(); }, iperiod);
+  }
+
+  void ControlLoopScheduler::step() {
+    for (std::size_t i = 0; i < count; i++) {
+      Entry& entry = loops[order[i]];
+
+      //Releases are whole ms on the kernel tick, so the task can sleep until exactly the next one
+      if (static_cast<long>(PAL::millis() - entry.nextRun) < 0)
+        continue;
+
+      const unsigned long start = PAL::micros();
+      const float dt = entry.hasRun ? static_cast<float>(start - entry.lastRun) / 1000.0 : static_cast<float>(entry.period);
+      entry.loop(dt);
+
+      const unsigned long end = PAL::micros();
+      if (end - start > entry.maxExecTime)
+        entry.maxExecTime = end - start;
+
+      entry.lastRun = start;
+      entry.hasRun = true;
+      entry.nextRun += entry.period;
+
+      //Skip every release we already missed instead of running back to back to catch up
+      const unsigned long endMs = PAL::millis();
+      if (static_cast<long>(endMs - entry.nextRun) >= 0) {
+        const unsigned long missed = (endMs - entry.nextRun) / entry.period + 1;
+        entry.overruns += missed;
+        entry.nextRun += missed * entry.period;
+      }
+    }
+  }
+
+  void ControlLoopScheduler::loop() {
+    unsigned long wakeTime = PAL::millis();
+
+    while (true) {
+      step();
+
+      //Sleep until the earliest release, counted from the last wake time rather than from now so
+      //neither the time step() took nor rounding pushes the schedule back. step() moved every due
+      //release past the current time, so this is always at least one ms ahead of wakeTime
+      long untilNext = static_cast<long>(loops[order[0]].nextRun - wakeTime);
+      for (std::size_t i = 1; i < count; i++) {
+        const long until = static_cast<long>(loops[order[i]].nextRun - wakeTime);
+        if (until < untilNext)
+          untilNext = until;
+      }
+
+      PAL::taskDelayUntil(&wakeTime, untilNext > 0 ? static_cast<unsigned long>(untilNext) : 1);
+    }
+  }
+
+  void ControlLoopScheduler::start(const unsigned int ipriority) {
+    if (!isStarted && count > 0) {
+      isStarted = true;
+
+      const unsigned long now = PAL::millis();
+      for (std::size_t i = 0; i < count; i++)
+        loops[i].nextRun = now;
+
+      PAL::taskCreate((TaskCode)ControlLoopScheduler::trampoline, TASK_DEFAULT_STACK_SIZE, this, ipriority);
+    }
+  }
+
+  unsigned long ControlLoopScheduler::getTotalOverruns() const {
+    unsigned long total = 0;
+    for (std::size_t i = 0; i < count; i++)
+      total += loops[i].overruns;
+    return total;
+  }
+}
@@ -0,0 +1,120 @@
+#include "control/feedforwardVelController.h"
+#include "PAL/PAL.h"
+
+namespace okapi {
+  FeedforwardVelController::FeedforwardVelController(const VelFeedforward& ifeedforward, const float ikP, const float ikI, const VelMathParams& ivelParams):
+    feedforward(ifeedforward),
+    kP(ikP),
+    kI(ikI),
+    lastTime(0),
+    sampleTime(15),
+    target(0),
+    targetAccel(0),
+    error(0),
+    integral(0),
+    output(0),
+    outputMax(127),
+    outputMin(-127),
+    isOn(true),
+    velMath(ivelParams),
+    hasPosition(false),
+    velScale(ivelParams.ticksPerRev / 60) {}
+
+  float FeedforwardVelController::step(const float inewReading) {
+    if (isOn) {
+      const unsigned long now = PAL::micros();
+      float dtRatio;
+
+      if (isStepDue(now, lastTime, sampleTime, dtRatio)) {
+        update(inewReading, dtRatio);
+        lastTime = now;
+      }
+
+      return output;
+    }
+
+    return 0;
+  }
+
+  float FeedforwardVelController::stepDt(const float inewReading, const float idt) {
+    if (isOn) {
+      update(inewReading, idt / static_cast<float>(sampleTime));
+      lastTime = PAL::micros();
+      return output;
+    }
+
+    return 0;
+  }
+
+  void FeedforwardVelController::setSetpoint(const float ivel, const float iaccel) {
+    target = ivel;
+    targetAccel = iaccel;
+  }
+
+  void FeedforwardVelController::setSampleTime(const int isampleTime) {
+    if (isampleTime > 0) {
+      kI *= static_cast<float>(isampleTime) / static_cast<float>(sampleTime);
+      sampleTime = isampleTime;
+    }
+  }
+
+  void FeedforwardVelController::setOutputLimits(float imax, float imin) {
+    //Always use larger value as max
+    if (imin > imax) {
+      const float temp = imax;
+      imax = imin;
+      imin = temp;
+    }
+
+    outputMax = imax;
+    outputMin = imin;
+
+    //Fix output and integral
+    if (output > outputMax)
+      output = outputMax;
+    else if (output < outputMin)
+      output = outputMin;
+
+    if (integral > outputMax)
+      integral = outputMax;
+    else if (integral < outputMin)
+      integral = outputMin;
+  }
+
+  void FeedforwardVelController::reset() {
+    error = 0;
+    integral = 0;
+    output = 0;
+    hasPosition = false;
+    lastTime = 0; //Run on the next step rather than a sample time after the last one
+  }
+
+  void FeedforwardVelController::setGains(const float ikP, const float ikI) {
+    kP = ikP;
+    kI = ikI;
+  }
+
+  void FeedforwardVelController::update(const float inewReading, const float idtRatio) {
+    if (!hasPosition) {
+      velMath.reset(inewReading);
+      hasPosition = true;
+      return;
+    }
+
+    const float vel = velMath.step(inewReading) * velScale;
+    error = target - vel;
+
+    integral += kI * error * idtRatio;
+    if (integral > outputMax)
+      integral = outputMax;
+    else if (integral < outputMin)
+      integral = outputMin;
+
+    output = feedforward.calculate(target, targetAccel) + kP * error + integral;
+
+    if (output > outputMax)
+      output = outputMax;
+    else if (output < outputMin)
+      output = outputMin;
+  }
+}
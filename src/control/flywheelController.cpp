@@ -0,0 +1,226 @@
+#include <cmath>
+#include "control/flywheelController.h"
+#include "PAL/PAL.h"
+
+namespace okapi {
+  FlywheelController::FlywheelController(const VelMathParams& ivelParams):
+    target(0),
+    error(0),
+    output(0),
+    outputMax(127),
+    outputMin(-127),
+    sampleTime(15),
+    lastTime(0),
+    isOn(true),
+    velMath(ivelParams),
+    readyBand(0.03),
+    shotDrop(0.06),
+    recoveredBand(0.02),
+    shotTime(60000),
+    lastReadyTime(0),
+    isArmed(false),
+    recovering(false),
+    shotCount(0),
+    hasPosition(false) {}
+
+  float FlywheelController::step(const float inewReading) {
+    if (isOn) {
+      const unsigned long now = PAL::micros();
+      float dtRatio;
+
+      if (isStepDue(now, lastTime, sampleTime, dtRatio)) {
+        update(inewReading, dtRatio);
+        lastTime = now;
+      }
+
+      return output;
+    }
+
+    return 0;
+  }
+
+  float FlywheelController::stepDt(const float inewReading, const float idt) {
+    if (isOn) {
+      update(inewReading, idt / static_cast<float>(sampleTime));
+      lastTime = PAL::micros();
+      return output;
+    }
+
+    return 0;
+  }
+
+  void FlywheelController::setTarget(const float itarget) {
+    target = itarget;
+    isArmed = false;
+    recovering = false;
+  }
+
+  void FlywheelController::setSampleTime(const int isampleTime) {
+    if (isampleTime > 0)
+      sampleTime = isampleTime;
+  }
+
+  void FlywheelController::setOutputLimits(float imax, float imin) {
+    //Always use larger value as max
+    if (imin > imax) {
+      const float temp = imax;
+      imax = imin;
+      imin = temp;
+    }
+
+    outputMax = imax;
+    outputMin = imin;
+
+    //Fix output
+    if (output > outputMax)
+      output = outputMax;
+    else if (output < outputMin)
+      output = outputMin;
+  }
+
+  void FlywheelController::reset() {
+    error = 0;
+    output = 0;
+    isArmed = false;
+    recovering = false;
+    shotCount = 0;
+    hasPosition = false;
+    lastTime = 0; //Run on the next step rather than a sample time after the last one
+    lastReadyTime = 0;
+  }
+
+  void FlywheelController::setShotDetection(const float ireadyBand, const float ishotDrop, const float irecoveredBand, const unsigned long ishotTime) {
+    readyBand = ireadyBand;
+    shotDrop = ishotDrop;
+    recoveredBand = irecoveredBand;
+    shotTime = ishotTime * 1000;
+  }
+
+  bool FlywheelController::isReady() const {
+    return !recovering && target != 0 && std::fabs(error) <= readyBand * std::fabs(target);
+  }
+
+  void FlywheelController::update(const float inewReading, const float idtRatio) {
+    if (!hasPosition) {
+      velMath.reset(inewReading);
+      hasPosition = true;
+      return;
+    }
+
+    const float vel = velMath.step(inewReading);
+    error = target - vel;
+
+    //Work in terms of how far the flywheel is below its target, so either direction works
+    const float direction = target < 0 ? -1 : 1;
+    const float shortfall = direction * error;
+    const float magnitude = std::fabs(target);
+    const float boost = direction > 0 ? outputMax : outputMin;
+
+    if (recovering) {
+      if (shortfall > recoveredBand * magnitude) {
+        output = boost;
+        return;
+      }
+
+      recovering = false;
+      onRecovered();
+    }
+
+    //Only armed while at speed or just after, so neither spinning up nor a slow sag (like a
+    //take-back-half overshoot coming back down) is mistaken for a shot
+    const unsigned long now = PAL::micros();
+    if (isReady()) {
+      isArmed = true;
+      lastReadyTime = now;
+    } else if (now - lastReadyTime > shotTime) {
+      isArmed = false;
+    }
+
+    if (isArmed && shotDrop > 0 && shortfall > shotDrop * magnitude) {
+      shotCount++;
+      isArmed = false;
+      recovering = true;
+      output = boost;
+      return;
+    }
+
+    output = compute(vel, idtRatio);
+
+    if (output > outputMax)
+      output = outputMax;
+    else if (output < outputMin)
+      output = outputMin;
+  }
+
+  TbhController::TbhController(const float igain, const float iestimate, const VelMathParams& ivelParams):
+    FlywheelController(ivelParams),
+    gain(igain),
+    estimate(iestimate),
+    tbh(0),
+    lastError(0),
+    hasCrossed(false) {}
+
+  void TbhController::setTarget(const float itarget) {
+    FlywheelController::setTarget(itarget);
+    hasCrossed = false;
+  }
+
+  void TbhController::reset() {
+    FlywheelController::reset();
+    tbh = 0;
+    lastError = 0;
+    hasCrossed = false;
+  }
+
+  float TbhController::compute(const float, const float idtRatio) {
+    float next = output + gain * error * idtRatio;
+
+    if (lastError != 0 && (error > 0) != (lastError > 0)) {
+      next = !hasCrossed && estimate != 0 ? estimate : 0.5f * (next + tbh);
+      tbh = next;
+      hasCrossed = true;
+    }
+
+    lastError = error;
+    return next;
+  }
+
+  void TbhController::onRecovered() {
+    //Pick up from the power which held the target before the shot, not from the boost
+    if (hasCrossed)
+      output = tbh;
+    lastError = error;
+  }
+
+  BangBangController::BangBangController(const float ilowBand, const float ihighBand, const float ihighPower, const float ilowPower, const VelMathParams& ivelParams):
+    FlywheelController(ivelParams),
+    lowBand(ilowBand),
+    highBand(ihighBand),
+    highPower(ihighPower),
+    lowPower(ilowPower) {}
+
+  float BangBangController::compute(const float, const float) {
+    const float direction = target < 0 ? -1 : 1;
+    const float shortfall = direction * error;
+
+    if (shortfall > lowBand)
+      return highPower != 0 ? direction * highPower : (direction > 0 ? outputMax : outputMin);
+    if (shortfall < -highBand)
+      return direction * lowPower;
+    return output;
+  }
+
+  FeedforwardFlywheelController::FeedforwardFlywheelController(const float ikF, const float ikP, const VelMathParams& ivelParams):
+    FlywheelController(ivelParams),
+    kF(ikF),
+    kP(ikP) {}
+
+  void FeedforwardFlywheelController::setGains(const float ikF, const float ikP) {
+    kF = ikF;
+    kP = ikP;
+  }
+
+  float FeedforwardFlywheelController::compute(const float, const float) {
+    return kF * target + kP * error;
+  }
+}
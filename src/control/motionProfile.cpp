@@ -0,0 +1,102 @@
+#include <cmath>
+#include "control/motionProfile.h"
+
+namespace okapi {
+  constexpr std::size_t MotionProfile::maxSegments;
+
+  MotionProfile::MotionProfile(const MotionProfileParams& iparams):
+    params(iparams),
+    distance(0),
+    duration(0),
+    sign(1) {}
+
+  float MotionProfile::rampTime(const float ivel, float& ojerkTime) const {
+    if (params.maxJerk <= 0) {
+      ojerkTime = 0;
+      return ivel / params.maxAccel;
+    }
+
+    if (ivel * params.maxJerk >= params.maxAccel * params.maxAccel) {
+      //Reaches max acceleration, holds it, then eases off
+      ojerkTime = params.maxAccel / params.maxJerk;
+      return ivel / params.maxAccel + ojerkTime;
+    }
+
+    //Never reaches max acceleration
+    ojerkTime = std::sqrt(ivel / params.maxJerk);
+    return 2 * ojerkTime;
+  }
+
+  void MotionProfile::generate(const float idistance) {
+    sign = idistance < 0 ? -1 : 1;
+    distance = std::fabs(idistance);
+    duration = 0;
+    segments.fill(Segment());
+
+    if (distance == 0 || params.maxVel <= 0 || params.maxAccel <= 0)
+      return;
+
+    //Accelerating from rest to vel covers vel * rampTime / 2 because the ramp is symmetric. If
+    //speeding up and slowing down from maxVel would overshoot, find the peak velocity which fits
+    float jerkTime = 0;
+    float vel = params.maxVel;
+    float accelTime = rampTime(vel, jerkTime);
+
+    if (vel * accelTime > distance) {
+      float low = 0, high = params.maxVel;
+      for (int i = 0; i < 32; i++) {
+        vel = (low + high) / 2;
+        if (vel * rampTime(vel, jerkTime) > distance)
+          high = vel;
+        else
+          low = vel;
+      }
+
+      vel = low;
+      accelTime = rampTime(vel, jerkTime);
+    }
+
+    const float cruiseTime = (distance - vel * accelTime) / vel;
+    const float constAccelTime = accelTime - 2 * jerkTime;
+    const float peakAccel = jerkTime > 0 ? params.maxJerk * jerkTime : params.maxAccel;
+    const float jerk = params.maxJerk > 0 ? params.maxJerk : 0;
+
+    const std::array<float, maxSegments> times{{jerkTime, constAccelTime, jerkTime, cruiseTime, jerkTime, constAccelTime, jerkTime}};
+    const std::array<float, maxSegments> accels{{0, peakAccel, peakAccel, 0, 0, -peakAccel, -peakAccel}};
+    const std::array<float, maxSegments> jerks{{jerk, 0, -jerk, 0, -jerk, 0, jerk}};
+
+    float time = 0, pos = 0, velocity = 0;
+    for (std::size_t i = 0; i < maxSegments; i++) {
+      const float dt = times[i];
+      segments[i].time = time;
+      segments[i].start = MotionSetpoint(pos, velocity, accels[i]);
+      segments[i].jerk = jerks[i];
+
+      pos += velocity * dt + accels[i] * dt * dt / 2 + jerks[i] * dt * dt * dt / 6;
+      velocity += accels[i] * dt + jerks[i] * dt * dt / 2;
+      time += dt;
+    }
+
+    duration = time;
+  }
+
+  MotionSetpoint MotionProfile::get(const float itime) const {
+    if (itime >= duration)
+      return MotionSetpoint(sign * distance, 0, 0);
+
+    if (itime <= 0)
+      return MotionSetpoint();
+
+    std::size_t i = maxSegments - 1;
+    while (i > 0 && segments[i].time > itime)
+      i--;
+
+    const Segment& seg = segments[i];
+    const float dt = itime - seg.time;
+    const float pos = seg.start.position + seg.start.velocity * dt + seg.start.acceleration * dt * dt / 2 + seg.jerk * dt * dt * dt / 6;
+    const float vel = seg.start.velocity + seg.start.acceleration * dt + seg.jerk * dt * dt / 2;
+    const float accel = seg.start.acceleration + seg.jerk * dt;
+
+    return MotionSetpoint(sign * pos, sign * vel, sign * accel);
+  }
+}
@@ -14,4 +14,17 @@ namespace okapi {
 
     return Pid::output;
   }
+
+  float NsPid::stepDt(const float inewReading, const float idt) {
+    using namespace std;
+
+    Pid::stepDt(inewReading, idt); //Main control loop
+
+    //Check if velocity is sufficiently small
+    if (fabs(velMath.step(inewReading)) < minVel) {
+      return scale * Pid::output;
+    }
+
+    return Pid::output;
+  }
 }
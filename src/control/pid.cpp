@@ -52,42 +52,59 @@ namespace okapi {
   }
 
   float Pid::step(const float inewReading) {
-    using namespace std; //Needed to get copysign to compile
+    if (isOn) {
+      const unsigned long now = PAL::micros();
+      float dtRatio;
+
+      if (isStepDue(now, lastTime, sampleTime, dtRatio)) {
+        update(inewReading, dtRatio);
+        lastTime = now; //Only when the step ran, so a skipped early call keeps counting from the last run
+      }
+    } else {
+      output = 0; //Controller is off so write 0
+    }
 
+    return output;
+  }
+
+  float Pid::stepDt(const float inewReading, const float idt) {
     if (isOn) {
-      const long now = PAL::millis();
+      update(inewReading, idt / static_cast<float>(sampleTime));
+      lastTime = PAL::micros();
+    } else {
+      output = 0; //Controller is off so write 0
+    }
+
+    return output;
+  }
 
-      if (now - lastTime >= sampleTime) {
-        error = target - inewReading;
+  void Pid::update(const float inewReading, const float idtRatio) {
+    using namespace std; //Needed to get copysign to compile
 
-        integral += kI * error; //Eliminate integral kick while realtime tuning
+    error = target - inewReading;
 
-        if (shouldResetOnCross && copysign(1.0, (float)error) != copysign(1.0, (float)lastError))
-          integral = 0;
+    integral += kI * error * idtRatio; //Eliminate integral kick while realtime tuning
 
-        if (integral > integralMax)
-          integral = integralMax;
-        else if (integral < integralMin)
-          integral = integralMin;
+    if (shouldResetOnCross && copysign(1.0, (float)error) != copysign(1.0, (float)lastError))
+      integral = 0;
 
-        const float derivative = inewReading - lastReading; //Derivative over measurement to eliminate derivative kick on setpoint change
+    if (integral > integralMax)
+      integral = integralMax;
+    else if (integral < integralMin)
+      integral = integralMin;
 
-        output = kP * error + integral - kD * derivative + kBias;
+    //Derivative over measurement to eliminate derivative kick on setpoint change
+    const float derivative = idtRatio > 0 ? (inewReading - lastReading) / idtRatio : 0;
 
-        if (output > outputMax)
-          output = outputMax;
-        else if (output < outputMin)
-          output = outputMin;
+    output = kP * error + integral - kD * derivative + kBias;
 
-        lastReading = inewReading;
-        lastError = error;
-        lastTime = now; //Important that we only assign lastTime if dt >= sampleTime
-      }
-    } else {
-      output = 0; //Controller is off so write 0
-    }
+    if (output > outputMax)
+      output = outputMax;
+    else if (output < outputMin)
+      output = outputMin;
 
-    return output;
+    lastReading = inewReading;
+    lastError = error;
   }
 
   void Pid::setGains(const float ikP, const float ikI, const float ikD, const float ikBias) {
@@ -1,16 +1,75 @@
+#include <cmath>
 #include "control/velMath.h"
 #include "PAL/PAL.h"
 
 namespace okapi {
+  constexpr std::size_t VelMath::windowSize;
+
   float VelMath::step(const float inewPos) {
-    const long now = PAL::millis();
+    const unsigned long now = PAL::micros();
+    const unsigned long dt = now - lastTime;
+
+    if (dt == 0)
+      return vel; //No time has passed, so there is nothing to differentiate
+
+    lastVel = vel;
 
-    vel = static_cast<float>((1000 / (now - lastTime))) * (inewPos - lastPos) * (60 / ticksPerRev);
-    vel = filter.filter(vel);
+    if (minTicks > 0) {
+      samples[sampleCount % windowSize] = {now, inewPos};
+      sampleCount++;
+      vel = windowSlope() * (60 / ticksPerRev) * 1000000;
+    } else {
+      const float rawVel = (inewPos - lastPos) * (60 / ticksPerRev) * (1000000 / static_cast<float>(dt));
+      if (isRestarted) {
+        filter.reset(rawVel);
+        vel = rawVel;
+      } else {
+        vel = filter.filter(rawVel);
+      }
+    }
 
     lastPos = inewPos;
     lastTime = now;
+    isRestarted = false;
 
     return vel;
   }
+
+  void VelMath::reset(const float ipos) {
+    lastTime = PAL::micros();
+    vel = 0;
+    lastVel = 0;
+    lastPos = ipos;
+    filter.reset();
+    samples[0] = {lastTime, ipos};
+    sampleCount = 1;
+    isRestarted = true;
+  }
+
+  void VelMath::setWindow(const float iminTicks, const unsigned long imaxWindow) {
+    minTicks = iminTicks;
+    maxWindow = imaxWindow * 1000;
+    sampleCount = 0; //Samples from before a switch out of adaptive mode would be stale
+  }
+
+  float VelMath::windowSlope() const {
+    if (sampleCount < 2)
+      return 0;
+
+    const Sample& newest = samples[(sampleCount - 1) % windowSize];
+    const std::size_t oldestAge = sampleCount < windowSize ? sampleCount - 1 : windowSize - 1;
+
+    //Walk back until the window spans enough ticks to keep quantization noise down, or until it
+    //is as long as we allow. At high speed that is the previous sample, so there is no extra lag
+    std::size_t age = 1;
+    while (age < oldestAge) {
+      const Sample& sample = samples[(sampleCount - 1 - age) % windowSize];
+      if (std::fabs(newest.pos - sample.pos) >= minTicks || newest.time - sample.time >= maxWindow)
+        break;
+      age++;
+    }
+
+    const Sample& oldest = samples[(sampleCount - 1 - age) % windowSize];
+    return (newest.pos - oldest.pos) / static_cast<float>(newest.time - oldest.time);
+  }
 }
@@ -39,30 +39,49 @@ namespace okapi {
 
   float VelPid::step(const float inewReading) {
     if (isOn) {
-      const long now = PAL::millis();
-      if (now - lastTime >= sampleTime) {
-        stepVel(inewReading);
-        const float error = target - velMath.getOutput();
+      const unsigned long now = PAL::micros();
+      float dtRatio;
 
-        const float derivative = velMath.getDiff(); //Derivative over measurement to eliminate derivative kick on setpoint change
-
-        output += kP * error - kD * derivative;
+      if (isStepDue(now, lastTime, sampleTime, dtRatio)) {
+        update(inewReading, dtRatio);
+        lastTime = now; //Only when the step ran, so a skipped early call keeps counting from the last run
+      }
 
-        if (output > outputMax)
-          output = outputMax;
-        else if (output < outputMin)
-          output = outputMin;
+      return output;
+    }
 
-        lastError = error;
-        lastTime = now; //Important that we only assign lastTime if dt >= sampleTime
-      }
+    return 0;
+  }
 
+  float VelPid::stepDt(const float inewReading, const float idt) {
+    if (isOn) {
+      update(inewReading, idt / static_cast<float>(sampleTime));
+      lastTime = PAL::micros();
       return output;
     }
 
     return 0;
   }
 
+  void VelPid::update(const float inewReading, const float idtRatio) {
+    stepVel(inewReading);
+    error = target - velMath.getOutput();
+
+    //Derivative over measurement to eliminate derivative kick on setpoint change
+    const float derivative = idtRatio > 0 ? velMath.getDiff() / idtRatio : 0;
+
+    //The output accumulates kP * error per sample time, so a late or early step adds in
+    //proportion to how long it really was
+    output += kP * error * idtRatio - kD * derivative;
+
+    if (output > outputMax)
+      output = outputMax;
+    else if (output < outputMin)
+      output = outputMin;
+
+    lastError = error;
+  }
+
   void VelPid::reset() {
     error = 0;
     lastError = 0;
@@ -0,0 +1,126 @@
+#include <cmath>
+#include "device/edgeEncoder.h"
+
+namespace okapi {
+  constexpr std::size_t EdgeEncoder::historySize;
+  constexpr std::size_t EdgeEncoder::maxEdges;
+  constexpr std::size_t EdgeEncoder::maxAccelEdges;
+
+  namespace {
+    //Interrupt handlers only get the pin, so each pin maps back to its encoder
+    EdgeEncoder *encoders[BOARD_NR_GPIO_PINS + 1] = {};
+
+    //Change in count from old state (high two bits) to new state (low two bits), in Gray code
+    //order 00, 01, 11, 10. Entries for both channels changing at once are 0
+    constexpr signed char steps[16] = {0, 1, -1, 0, -1, 0, 0, 1, 1, 0, 0, -1, 0, -1, 1, 0};
+
+    float ticksToRpm(const EncoderEdge& ifirst, const EncoderEdge& ilast) {
+      return static_cast<float>(ifirst.count - ilast.count) * (60.0f / 360.0f) * 1000000 / static_cast<float>(ifirst.time - ilast.time);
+    }
+  }
+
+  EdgeEncoder::EdgeEncoder(const unsigned char iportTop, const unsigned char iportBottom, const bool ireversed, const unsigned long imaxWindow):
+    portTop(iportTop),
+    portBottom(iportBottom),
+    reversed(ireversed),
+    maxWindow(imaxWindow * 1000),
+    count(0),
+    offset(0),
+    state(0),
+    errors(0) {
+    PAL::pinMode(portTop, INPUT);
+    PAL::pinMode(portBottom, INPUT);
+    state = static_cast<unsigned char>((PAL::digitalRead(portTop) << 1) | PAL::digitalRead(portBottom));
+
+    encoders[portTop] = this;
+    encoders[portBottom] = this;
+    PAL::ioSetInterrupt(portTop, INTERRUPT_EDGE_BOTH, EdgeEncoder::handleInterrupt);
+    PAL::ioSetInterrupt(portBottom, INTERRUPT_EDGE_BOTH, EdgeEncoder::handleInterrupt);
+  }
+
+  EdgeEncoder::~EdgeEncoder() {
+    PAL::ioClearInterrupt(portTop);
+    PAL::ioClearInterrupt(portBottom);
+    encoders[portTop] = nullptr;
+    encoders[portBottom] = nullptr;
+  }
+
+  void EdgeEncoder::handleInterrupt(unsigned char ipin) {
+    if (ipin <= BOARD_NR_GPIO_PINS && encoders[ipin] != nullptr)
+      encoders[ipin]->onEdge();
+  }
+
+  void EdgeEncoder::onEdge() {
+    const unsigned long now = PAL::micros();
+    const unsigned char newState = static_cast<unsigned char>((PAL::digitalRead(portTop) << 1) | PAL::digitalRead(portBottom));
+    const int step = steps[(state << 2) | newState];
+
+    if (step == 0) {
+      //Both channels changed, so an edge was missed and the direction is unknown
+      if (newState != state)
+        errors.fetch_add(1, std::memory_order_relaxed);
+      state = newState;
+      return;
+    }
+
+    state = newState;
+
+    //Only interrupt handlers write count, and they do not preempt each other
+    const int newCount = count.load(std::memory_order_relaxed) + (reversed ? -step : step);
+    count.store(newCount, std::memory_order_relaxed);
+    edges.push({now, newCount});
+  }
+
+  std::size_t EdgeEncoder::findSpan(const std::size_t istart, EncoderEdge& ofirst, EncoderEdge& olast, const std::size_t imaxEdges) const {
+    if (!edges.get(istart, ofirst))
+      return 0;
+
+    //Take as many edges as fit in the window, in whole cycles of four once there are that many
+    std::size_t span = 0;
+    EncoderEdge edge;
+    while (span < imaxEdges && edges.get(istart + span + 1, edge) && ofirst.time - edge.time <= maxWindow)
+      span++;
+
+    if (span >= 4)
+      span -= span % 4;
+
+    return span > 0 && edges.get(istart + span, olast) && ofirst.time != olast.time ? span : 0;
+  }
+
+  float EdgeEncoder::getVelocity() const {
+    EncoderEdge first, last;
+    const std::size_t span = findSpan(0, first, last, maxEdges);
+    if (span == 0)
+      return 0;
+
+    const unsigned long now = PAL::micros();
+    if (now - first.time > maxWindow)
+      return 0;
+
+    //A stopped encoder sends no edges, so cap the speed at what it would be if one more edge
+    //arrived right now. Taken over the whole run, so uneven spacing between channels does not trip it
+    const float vel = ticksToRpm(first, last);
+    const float ceiling = static_cast<float>(span + 1) * (60.0f / 360.0f) * 1000000 / static_cast<float>(now - last.time);
+    if (std::fabs(vel) > ceiling)
+      return vel > 0 ? ceiling : -ceiling;
+
+    return vel;
+  }
+
+  float EdgeEncoder::getAcceleration() const {
+    EncoderEdge newFirst, newLast, oldFirst, oldLast;
+
+    //The older run starts where the newer one ends
+    const std::size_t span = findSpan(0, newFirst, newLast, maxAccelEdges);
+    if (span == 0 || findSpan(span, oldFirst, oldLast, maxAccelEdges) == 0)
+      return 0;
+
+    //Each velocity is the average over its run, so it belongs to the middle of the run
+    const float newMid = 0.5f * static_cast<float>(newFirst.time - oldLast.time) + 0.5f * static_cast<float>(newLast.time - oldLast.time);
+    const float oldMid = 0.5f * static_cast<float>(oldFirst.time - oldLast.time);
+    if (newMid <= oldMid)
+      return 0;
+
+    return (ticksToRpm(newFirst, newLast) - ticksToRpm(oldFirst, oldLast)) * 1000000 / (newMid - oldMid);
+  }
+}
@@ -0,0 +1,79 @@
+#include "device/sensorSampler.h"
+
+namespace okapi {
+  constexpr std::size_t SensorSnapshot::maxRotarySensors;
+  constexpr std::size_t SensorSnapshot::analogChannels;
+  constexpr std::size_t SensorSnapshot::maxRangeFinders;
+
+  int SensorSampler::addRotarySensor(const std::shared_ptr<RotarySensor>& isensor) {
+    if (isStarted || rotaryCount >= SensorSnapshot::maxRotarySensors)
+      return -1;
+
+    rotarySensors[rotaryCount] = isensor;
+    return static_cast<int>(rotaryCount++);
+  }
+
+  int SensorSampler::addAnalog(const unsigned char ichannel) {
+    if (isStarted || ichannel < 1 || ichannel > SensorSnapshot::analogChannels)
+      return -1;
+
+    analogMask |= 1u << (ichannel - 1);
+    return ichannel - 1;
+  }
+
+  int SensorSampler::addRangeFinder(const std::shared_ptr<RangeFinder>& isensor) {
+    if (isStarted || rangeCount >= SensorSnapshot::maxRangeFinders)
+      return -1;
+
+    rangeFinders[rangeCount] = isensor;
+    return static_cast<int>(rangeCount++);
+  }
+
+  void SensorSampler::sample() {
+    SensorSnapshot& back = snapshot.getBack();
+    back.timestamp = PAL::micros();
+
+    for (std::size_t i = 0; i < rotaryCount; i++)
+      back.rotary[i] = rotarySensors[i]->get();
+
+    for (std::size_t i = 0; i < SensorSnapshot::analogChannels; i++)
+      if (analogMask & (1u << i))
+        back.analog[i] = PAL::analogRead(static_cast<unsigned char>(i + 1));
+
+    for (std::size_t i = 0; i < rangeCount; i++)
+      back.range[i] = rangeFinders[i]->get();
+
+    snapshot.publish();
+  }
+
+  void SensorSampler::loop() {
+    unsigned long now = PAL::millis();
+
+    while (true) {
+      PAL::mutexTake(sampleMutex, maxDelay);
+      sample();
+      PAL::mutexGive(sampleMutex);
+      PAL::taskDelayUntil(&now, period);
+    }
+  }
+
+  void SensorSampler::start() {
+    if (!isStarted) {
+      isStarted = true;
+      sampleMutex = PAL::mutexCreate();
+      sample();
+      PAL::taskCreate((TaskCode)SensorSampler::trampoline, TASK_DEFAULT_STACK_SIZE, this, TASK_PRIORITY_DEFAULT + 2);
+    }
+  }
+
+  void SensorSampler::resetRotary(const int iindex) {
+    if (sampleMutex != nullptr)
+      PAL::mutexTake(sampleMutex, maxDelay);
+
+    rotarySensors[static_cast<std::size_t>(iindex)]->reset();
+    sample();
+
+    if (sampleMutex != nullptr)
+      PAL::mutexGive(sampleMutex);
+  }
+}
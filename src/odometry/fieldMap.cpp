@@ -0,0 +1,39 @@
+#include <cmath>
+#include "odometry/fieldMap.h"
+#include "util/fastMath.h"
+
+namespace okapi {
+  bool FieldMap::raycast(const float ix, const float iy, const float itheta, RaycastHit& ohit) const {
+    const float rayX = FastMath::cos(itheta);
+    const float rayY = FastMath::sin(itheta);
+
+    bool isHit = false;
+
+    for (std::size_t i = 0; i < count; i++) {
+      const FieldSegment& wall = walls[i];
+
+      //Range along the ray to the wall's line is num / den, and den is also the cosine of the
+      //angle between the ray and the wall's normal
+      const float den = rayX * wall.normalX + rayY * wall.normalY;
+      const float num = wall.offset - (ix * wall.normalX + iy * wall.normalY);
+      if (den == 0 || (num > 0) != (den > 0))
+        continue; //Parallel, or the line is behind the ray
+
+      const float range = num / den;
+      if (isHit && range >= ohit.range)
+        continue;
+
+      //Only count it if the ray crosses between the wall's ends
+      const float along = ((ix + range * rayX - wall.x1) * wall.dx + (iy + range * rayY - wall.y1) * wall.dy) * wall.invLengthSq;
+      if (along < 0 || along > 1)
+        continue;
+
+      isHit = true;
+      ohit.range = range;
+      ohit.wall = i;
+      ohit.incidence = std::fabs(den);
+    }
+
+    return isHit;
+  }
+}
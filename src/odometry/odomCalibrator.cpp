@@ -0,0 +1,179 @@
+#include <cstdint>
+#include <cstring>
+#include "odometry/odomCalibrator.h"
+#include "PAL/PAL.h"
+
+namespace okapi {
+  namespace {
+    constexpr std::uint32_t calibrationMagic = 0x4C41434F; //"OCAL"
+    constexpr std::size_t calibrationSize = 4 * sizeof(std::uint32_t); //Magic, three floats
+
+    std::uint32_t checksum(const unsigned char *idata, const std::size_t ilength) {
+      std::uint32_t sum = 0;
+      for (std::size_t i = 0; i < ilength; i++)
+        sum = sum * 31 + idata[i];
+      return sum;
+    }
+  }
+
+  void OdomCalibration::apply(OdomParams& oparams) const {
+    oparams.scale = scale;
+    oparams.turnScale = turnScale;
+    oparams.mismatch = mismatch;
+  }
+
+  void OdomCalibration::apply(Odometry& iodom) const {
+    iodom.setScales(scale, turnScale, mismatch);
+  }
+
+  bool OdomCalibration::save(const char *ifile) const {
+    unsigned char buffer[calibrationSize + sizeof(std::uint32_t)];
+    std::memcpy(buffer, &calibrationMagic, sizeof(std::uint32_t));
+    std::memcpy(buffer + 4, &scale, sizeof(float));
+    std::memcpy(buffer + 8, &turnScale, sizeof(float));
+    std::memcpy(buffer + 12, &mismatch, sizeof(float));
+
+    const std::uint32_t sum = checksum(buffer, calibrationSize);
+    std::memcpy(buffer + calibrationSize, &sum, sizeof(std::uint32_t));
+
+    PROS_FILE *file = PAL::fopen(ifile, "w");
+    if (file == nullptr)
+      return false;
+
+    const std::size_t written = PAL::fwrite(buffer, 1, sizeof(buffer), file);
+    PAL::fclose(file);
+    return written == sizeof(buffer);
+  }
+
+  bool OdomCalibration::load(const char *ifile) {
+    PROS_FILE *file = PAL::fopen(ifile, "r");
+    if (file == nullptr)
+      return false;
+
+    unsigned char buffer[calibrationSize + sizeof(std::uint32_t)];
+    const std::size_t read = PAL::fread(buffer, 1, sizeof(buffer), file);
+    PAL::fclose(file);
+
+    std::uint32_t magic, sum;
+    std::memcpy(&magic, buffer, sizeof(std::uint32_t));
+    std::memcpy(&sum, buffer + calibrationSize, sizeof(std::uint32_t));
+    if (read != sizeof(buffer) || magic != calibrationMagic || sum != checksum(buffer, calibrationSize))
+      return false;
+
+    std::memcpy(&scale, buffer + 4, sizeof(float));
+    std::memcpy(&turnScale, buffer + 8, sizeof(float));
+    std::memcpy(&mismatch, buffer + 12, sizeof(float));
+    return true;
+  }
+
+  bool OdomCalibrator::calibrateDistance(const float idistance, std::function<bool()> iisDone, const std::shared_ptr<RotarySensor>& igyro, const unsigned long itimeout) {
+    const std::array<int, 2> start = model->getSensorVals();
+    const int gyroStart = igyro ? igyro->get() : 0;
+    const unsigned long startTime = PAL::millis();
+    unsigned long now = startTime;
+
+    bool isDone = false;
+    while (!(isDone = iisDone()) && now - startTime < itimeout) {
+      //Turning counterclockwise raises the gyro; steer clockwise (positive angle power) against it
+      int anglePower = igyro ? 5 * (igyro->get() - gyroStart) : 0;
+      if (anglePower > power / 2)
+        anglePower = power / 2;
+      else if (anglePower < -power / 2)
+        anglePower = -power / 2;
+
+      model->driveVector(power, anglePower);
+      PAL::taskDelayUntil(&now, 10);
+    }
+
+    const std::array<int, 2> end = model->getSensorVals();
+    model->stop();
+
+    const float left = static_cast<float>(end[0] - start[0]);
+    const float right = static_cast<float>(end[1] - start[1]);
+    if (!isDone || left <= 0 || right <= 0)
+      return false;
+
+    //Both sides drove idistance, so left * leftScale == right * rightScale == idistance with
+    //leftScale = scale * (1 + mismatch) and rightScale = scale * (1 - mismatch)
+    calibration.mismatch = (right - left) / (right + left);
+    calibration.scale = idistance * (left + right) / (2 * left * right);
+    return true;
+  }
+
+  bool OdomCalibrator::calibrateTurn(const float iturns, std::function<bool()> iisDone, const unsigned long itimeout) {
+    const std::array<int, 2> start = model->getSensorVals();
+    const unsigned long startTime = PAL::millis();
+    unsigned long now = startTime;
+
+    bool isDone = false;
+    while (!(isDone = iisDone()) && now - startTime < itimeout) {
+      model->turnClockwise(-power);
+      PAL::taskDelayUntil(&now, 10);
+    }
+
+    const std::array<int, 2> end = model->getSensorVals();
+    model->stop();
+
+    return isDone && solveTurn(360 * iturns, start, end);
+  }
+
+  bool OdomCalibrator::calibrateTurn(const float iturns, const std::shared_ptr<RotarySensor>& igyro, const float igyroScale, const unsigned long itimeout) {
+    const std::array<int, 2> start = model->getSensorVals();
+    const int gyroStart = igyro->get();
+    const float target = 360 * iturns;
+    const unsigned long startTime = PAL::millis();
+    unsigned long now = startTime;
+
+    float turned = 0;
+    while ((turned = static_cast<float>(igyro->get() - gyroStart) * igyroScale) < target) {
+      if (now - startTime >= itimeout) {
+        model->stop();
+        return false;
+      }
+
+      //Slow down for the last quarter turn so the robot does not coast far past the target
+      model->turnClockwise(target - turned < 90 ? -power / 2 : -power);
+      PAL::taskDelayUntil(&now, 10);
+    }
+
+    model->stop();
+
+    //The gyro sees the coast too, so it does not matter where exactly the robot stops. A robot
+    //that never settles (e.g. on a slope, or with a noisy encoder) gives no usable end point
+    const unsigned long elapsed = PAL::millis() - startTime;
+    std::array<int, 2> end;
+    if (!waitForStop(end, elapsed < itimeout ? itimeout - elapsed : 0))
+      return false;
+
+    return solveTurn(static_cast<float>(igyro->get() - gyroStart) * igyroScale, start, end);
+  }
+
+  bool OdomCalibrator::waitForStop(std::array<int, 2>& oend, const unsigned long itimeout) {
+    const unsigned long start = PAL::millis();
+    oend = model->getSensorVals();
+    int stillCount = 0;
+
+    while (stillCount < 10) {
+      if (PAL::millis() - start >= itimeout)
+        return false;
+
+      PAL::taskDelay(20);
+      const std::array<int, 2> vals = model->getSensorVals();
+      stillCount = vals == oend ? stillCount + 1 : 0;
+      oend = vals;
+    }
+
+    return true;
+  }
+
+  bool OdomCalibrator::solveTurn(const float idegrees, const std::array<int, 2>& istart, const std::array<int, 2>& iend) {
+    //Same weighting as Odometry::step, so the mismatch from calibrateDistance carries over
+    const float left = static_cast<float>(iend[0] - istart[0]) * (1 + calibration.mismatch);
+    const float right = static_cast<float>(iend[1] - istart[1]) * (1 - calibration.mismatch);
+    if (right - left <= 0)
+      return false;
+
+    calibration.turnScale = idegrees / ((right - left) / 2);
+    return true;
+  }
+}
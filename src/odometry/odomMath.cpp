@@ -1,18 +1,49 @@
 #include "odometry/odomMath.h"
 #include <cmath>
 #include "util/mathUtil.h"
+#include "util/fastMath.h"
 
 namespace okapi {
+  namespace {
+    /**
+     * atan of a ratio in [0, 1], as a polynomial (good to about 1e-5 radians) instead of
+     * FastMath's table so a loop over it can be vectorized
+     */
+    inline float atanPoly(const float iratio) {
+      const float sq = iratio * iratio;
+      return iratio * (0.99997726 + sq * (-0.33262347 + sq * (0.19354346 + sq * (-0.11643287 + sq * (0.05265332 + sq * -0.01172120)))));
+    }
+
+    /**
+     * Index of the smallest value, or icount if there are none
+     */
+    std::size_t argmin(const float *ivalues, const std::size_t icount) {
+      if (icount == 0)
+        return icount;
+
+      std::size_t index = 0;
+      float best = ivalues[0];
+      for (std::size_t i = 1; i < icount; i++) {
+        //Selects instead of an if, so this compiles to conditional moves
+        const bool isCloser = ivalues[i] < best;
+        best = isCloser ? ivalues[i] : best;
+        index = isCloser ? i : index;
+      }
+
+      return index;
+    }
+  }
+
   float OdomMath::computeDistanceToPoint(const float ix, const float iy, const OdomState& istate) {
     const float xDiff = ix - istate.x;
     const float yDiff = iy - istate.y;
-    return std::sqrt((xDiff * xDiff) + (yDiff * yDiff));
+    return FastMath::sqrt((xDiff * xDiff) + (yDiff * yDiff));
   }
 
   float OdomMath::computeAngleToPoint(const float ix, const float iy, const OdomState& istate) {
     const float xDiff = ix - istate.x;
     const float yDiff = iy - istate.y;
-    return (std::atan2(yDiff, xDiff) * radianToDegree) - istate.theta;
+    return (FastMath::atan2(yDiff, xDiff) * radianToDegree) - istate.theta;
   }
 
   DistanceAndAngle OdomMath::computeDistanceAndAngleToPoint(const float ix, const float iy, const OdomState& istate) {
@@ -21,7 +52,7 @@ namespace okapi {
     const float xDiff = ix - istate.x;
     const float yDiff = iy - istate.y;
     DistanceAndAngle out;
-    out.length = std::sqrt((xDiff * xDiff) + (yDiff * yDiff));
+    out.length = FastMath::sqrt((xDiff * xDiff) + (yDiff * yDiff));
 
     //Small xDiff is essentially dividing by zero, so avoid it and do custom math
     if (xDiff < 0.0001 && xDiff > -0.0001) {
@@ -38,15 +69,84 @@ namespace okapi {
           out.theta -= 360;
       }
     } else {
-      out.theta = (std::atan2(yDiff, xDiff) * radianToDegree) - istate.theta;
+      out.theta = (FastMath::atan2(yDiff, xDiff) * radianToDegree) - istate.theta;
     }
 
     return out;
   }
 
+  std::size_t OdomMath::computeDistancesAndAnglesToPoints(const float *ix, const float *iy, const std::size_t icount, const OdomState& istate, float *odistances, float *oangles) {
+    const float x = istate.x;
+    const float y = istate.y;
+
+    //Squared distances first, which is all the closest point needs
+    for (std::size_t i = 0; i < icount; i++) {
+      const float xDiff = ix[i] - x;
+      const float yDiff = iy[i] - y;
+      odistances[i] = xDiff * xDiff + yDiff * yDiff;
+    }
+
+    const std::size_t closest = argmin(odistances, icount);
+
+    //The squares are never negative, and invSqrt(0) is finite, so unlike FastMath::sqrt this
+    //needs no zero check
+    for (std::size_t i = 0; i < icount; i++)
+      odistances[i] *= FastMath::invSqrt(odistances[i]);
+
+    if (oangles == nullptr)
+      return closest;
+
+    const float theta = istate.theta;
+    for (std::size_t i = 0; i < icount; i++) {
+      const float xDiff = ix[i] - x;
+      const float yDiff = iy[i] - y;
+      const float absX = std::fabs(xDiff);
+      const float absY = std::fabs(yDiff);
+
+      //Same reduction as FastMath::atan2, but with no branches the compiler could turn back into
+      //control flow. The larger and smaller of the two come from arithmetic rather than a
+      //compare, and each half of the reduction picks between constants
+      const float gap = std::fabs(absX - absY);
+      const float big = 0.5 * (absX + absY + gap);
+      const float small = 0.5 * (absX + absY - gap);
+      const float ratioAngle = atanPoly(small / (big + 1e-30)); //The offset keeps 0 / 0 away
+
+      const bool isSteep = absY > absX;
+      const float octant = (isSteep ? 1.57079632679489661923 : 0) + (isSteep ? -1 : 1) * ratioAngle;
+      const float half = (xDiff < 0 ? 3.14159265358979323846 : 0) + (xDiff < 0 ? -1 : 1) * octant;
+      const float angle = (yDiff < 0 ? -radianToDegree : radianToDegree) * half - theta;
+
+      //The angle is in [-540, 540), so shifting it positive makes truncation a floor
+      const int turns = static_cast<int>((angle + 540) * (1.0 / 360));
+      const float wrapped = angle - 360 * static_cast<float>(turns - 1);
+      oangles[i] = wrapped;
+    }
+
+    return closest;
+  }
+
+  std::size_t OdomMath::findClosestPoint(const float *ix, const float *iy, const std::size_t icount, const OdomState& istate) {
+    if (icount == 0)
+      return icount;
+
+    std::size_t index = 0;
+    float best = 0;
+    for (std::size_t i = 0; i < icount; i++) {
+      const float xDiff = ix[i] - istate.x;
+      const float yDiff = iy[i] - istate.y;
+      const float sq = xDiff * xDiff + yDiff * yDiff;
+
+      const bool isCloser = i == 0 || sq < best;
+      best = isCloser ? sq : best;
+      index = isCloser ? i : index;
+    }
+
+    return index;
+  }
+
   std::tuple<float, float> OdomMath::guessScales(const float chassisDiam, const float wheelDiam, const float ticksPerRev) {
     const float scale = ((wheelDiam * pi * inchToMM) / ticksPerRev) * 0.9945483364; //This scale is usually off by this amount
-    const float turnScale = (1.0 / (chassisDiam * inchToMM)) * radianToDegree * 2;
+    const float turnScale = (scale / (chassisDiam * inchToMM)) * radianToDegree * 2;
     return std::make_tuple(scale, turnScale);
   }
 }
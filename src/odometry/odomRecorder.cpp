@@ -0,0 +1,180 @@
+#include <cstdint>
+#include <cstring>
+#include "odometry/odomRecorder.h"
+
+namespace okapi {
+  constexpr std::size_t OdomSample::channels;
+  constexpr std::size_t OdomRecorder::queueSize;
+
+  namespace {
+    //The file is an 8 byte header (magic, version, channel count) and then one record per sample.
+    //A record is a uint16 time since the previous sample in us and an int16 change per channel.
+    //A time of 0xFFFF marks a keyframe instead, holding a uint32 timestamp and int32 values,
+    //which starts the log and stands in for any sample too far from the previous one for int16s
+    constexpr std::uint32_t logMagic = 0x474F4C4F; //"OLOG"
+    constexpr std::uint16_t logVersion = 1;
+    constexpr std::uint16_t keyframe = 0xFFFF;
+    constexpr std::size_t headerSize = 8;
+    constexpr std::size_t deltaSize = 2 + 2 * OdomSample::channels;
+    constexpr std::size_t keyframeSize = 2 + 4 + 4 * OdomSample::channels;
+
+    std::size_t encode(const OdomSample& isample, const OdomSample *iprevious, unsigned char *obuffer) {
+      bool fits = iprevious != nullptr;
+      const std::uint32_t dt = fits ? static_cast<std::uint32_t>(isample.timestamp - iprevious->timestamp) : 0;
+      fits = fits && dt < keyframe;
+
+      std::array<std::int16_t, OdomSample::channels> deltas;
+      for (std::size_t i = 0; fits && i < OdomSample::channels; i++) {
+        const long delta = static_cast<long>(isample.ticks[i]) - iprevious->ticks[i];
+        fits = delta >= INT16_MIN && delta <= INT16_MAX;
+        deltas[i] = static_cast<std::int16_t>(delta);
+      }
+
+      if (fits) {
+        const std::uint16_t tag = static_cast<std::uint16_t>(dt);
+        std::memcpy(obuffer, &tag, 2);
+        std::memcpy(obuffer + 2, deltas.data(), 2 * OdomSample::channels);
+        return deltaSize;
+      }
+
+      const std::uint32_t timestamp = static_cast<std::uint32_t>(isample.timestamp);
+      std::memcpy(obuffer, &keyframe, 2);
+      std::memcpy(obuffer + 2, &timestamp, 4);
+      for (std::size_t i = 0; i < OdomSample::channels; i++) {
+        const std::int32_t value = isample.ticks[i];
+        std::memcpy(obuffer + 6 + 4 * i, &value, 4);
+      }
+      return keyframeSize;
+    }
+  }
+
+  bool OdomRecorder::start() {
+    if (isRecording || stream != nullptr)
+      return false;
+
+    stream = PAL::fopen(file, "w");
+    if (stream == nullptr)
+      return false;
+
+    unsigned char header[headerSize];
+    const std::uint16_t channelCount = OdomSample::channels;
+    std::memcpy(header, &logMagic, 4);
+    std::memcpy(header + 4, &logVersion, 2);
+    std::memcpy(header + 6, &channelCount, 2);
+    PAL::fwrite(header, 1, headerSize, stream);
+
+    hasLast = false;
+    isRecording = true;
+    PAL::taskCreate((TaskCode)OdomRecorder::trampoline, TASK_DEFAULT_STACK_SIZE, this, TASK_PRIORITY_LOWEST + 1);
+    return true;
+  }
+
+  void OdomRecorder::record(const OdomSample& isample) {
+    if (isRecording && !queue.push(isample))
+      dropped++;
+  }
+
+  void OdomRecorder::flush() {
+    //Batch records so the file system sees a few large writes instead of many tiny ones
+    unsigned char buffer[16 * keyframeSize];
+    std::size_t length = 0;
+    OdomSample sample;
+
+    while (queue.pop(sample)) {
+      length += encode(sample, hasLast ? &last : nullptr, buffer + length);
+      last = sample;
+      hasLast = true;
+      written++;
+
+      if (length > sizeof(buffer) - keyframeSize) {
+        PAL::fwrite(buffer, 1, length, stream);
+        length = 0;
+      }
+    }
+
+    if (length > 0)
+      PAL::fwrite(buffer, 1, length, stream);
+  }
+
+  void OdomRecorder::loop() {
+    unsigned long now = PAL::millis();
+
+    while (isRecording) {
+      flush();
+      PAL::taskDelayUntil(&now, flushPeriod);
+    }
+
+    flush();
+    PAL::fclose(stream);
+    stream = nullptr;
+    PAL::taskDelete(nullptr);
+  }
+
+  bool OdomLogReader::open(const char *ifile) {
+    close();
+
+    stream = PAL::fopen(ifile, "r");
+    if (stream == nullptr)
+      return false;
+
+    unsigned char header[headerSize];
+    std::uint32_t magic;
+    std::uint16_t version, channelCount;
+    const std::size_t read = PAL::fread(header, 1, headerSize, stream);
+    std::memcpy(&magic, header, 4);
+    std::memcpy(&version, header + 4, 2);
+    std::memcpy(&channelCount, header + 6, 2);
+
+    if (read != headerSize || magic != logMagic || version != logVersion || channelCount != OdomSample::channels) {
+      close();
+      return false;
+    }
+
+    hasLast = false;
+    return true;
+  }
+
+  bool OdomLogReader::next(OdomSample& osample) {
+    unsigned char buffer[keyframeSize];
+    if (stream == nullptr || PAL::fread(buffer, 1, 2, stream) != 2)
+      return false;
+
+    std::uint16_t tag;
+    std::memcpy(&tag, buffer, 2);
+
+    if (tag == keyframe) {
+      if (PAL::fread(buffer + 2, 1, keyframeSize - 2, stream) != keyframeSize - 2)
+        return false;
+
+      std::uint32_t timestamp;
+      std::memcpy(&timestamp, buffer + 2, 4);
+      last.timestamp = timestamp;
+      for (std::size_t i = 0; i < OdomSample::channels; i++) {
+        std::int32_t value;
+        std::memcpy(&value, buffer + 6 + 4 * i, 4);
+        last.ticks[i] = value;
+      }
+    } else {
+      if (!hasLast || PAL::fread(buffer + 2, 1, deltaSize - 2, stream) != deltaSize - 2)
+        return false;
+
+      last.timestamp = static_cast<std::uint32_t>(last.timestamp + tag);
+      for (std::size_t i = 0; i < OdomSample::channels; i++) {
+        std::int16_t delta;
+        std::memcpy(&delta, buffer + 2 + 2 * i, 2);
+        last.ticks[i] += delta;
+      }
+    }
+
+    hasLast = true;
+    osample = last;
+    return true;
+  }
+
+  void OdomLogReader::close() {
+    if (stream != nullptr) {
+      PAL::fclose(stream);
+      stream = nullptr;
+    }
+  }
+}
@@ -1,28 +1,231 @@
 #include <cmath>
 #include "odometry/odometry.h"
+#include "odometry/odomRecorder.h"
+#include "odometry/poseEstimator.h"
+#include "odometry/relocalizer.h"
 #include "util/mathUtil.h"
+#include "util/fastMath.h"
 #include "PAL/PAL.h"
 
 namespace okapi {
-  void Odometry::loop() {
-    unsigned long now = PAL::millis();
-    std::valarray<int> newTicks{0, 0}, tickDiff{0, 0};
+  constexpr std::size_t Odometry::historySize;
 
-    while (true) {
-      newTicks = model->getSensorVals();
-      tickDiff = newTicks - lastTicks;
-      mm = (static_cast<float>(tickDiff[1] + tickDiff[0]) / 2.0) * scale;
+  void Odometry::step() {
+    const unsigned long lastTimestamp = timestamp;
+    timestamp = PAL::micros();
+    const float dt = static_cast<float>(timestamp - lastTimestamp) / 1000000.0;
+
+    if (resets.getCount() != appliedResets) {
+      appliedResets = resets.getCount();
+      state = resets.read();
+      heading = state.theta * degreeToRadian;
+    }
+
+    //Tracking wheel mode needs both parallel wheels, since the heading comes from their difference
+    if (left.sensor && right.sensor) {
+      const std::array<int, 3> newTicks{{left.sensor->get(), right.sensor->get(), lateral.sensor ? lateral.sensor->get() : 0}};
+      const float leftMM = static_cast<float>(newTicks[0] - lastWheelTicks[0]) * left.scale;
+      const float rightMM = static_cast<float>(newTicks[1] - lastWheelTicks[1]) * right.scale;
+      const float lateralMM = static_cast<float>(newTicks[2] - lastWheelTicks[2]) * lateral.scale;
+
+      const float trackWidth = left.offset + right.offset;
+      const bool isMoving = newTicks[0] != lastWheelTicks[0] || newTicks[1] != lastWheelTicks[1] || newTicks[2] != lastWheelTicks[2];
+      const float dTheta = fuseHeading((rightMM - leftMM) / trackWidth, isMoving, dt);
+      lastWheelTicks = newTicks;
+
+      //Arc lengths traveled by the tracking center. The lateral wheel sits behind the center, so
+      //turning counterclockwise moves it right by offset * dTheta even if the robot did not slide
+      const float forwardArc = (leftMM * right.offset + rightMM * left.offset) / trackWidth;
+      const float lateralArc = lateralMM + lateral.offset * dTheta;
+
+      integrate(chord(forwardArc, dTheta), chord(lateralArc, dTheta), dTheta);
+    } else if (model) {
+      const std::array<int, 2> newTicks = model->getSensorVals();
+      const int leftDiff = newTicks[0] - lastTicks[0];
+      const int rightDiff = newTicks[1] - lastTicks[1];
       lastTicks = newTicks;
 
-      state.theta += (static_cast<float>(tickDiff[1] - tickDiff[0]) / 2.0) * turnScale;
-      if (state.theta > 180)
-        state.theta -= 360;
-      else if (state.theta < -180)
-        state.theta += 360;
+      const float leftTicks = static_cast<float>(leftDiff) * (1 + mismatch);
+      const float rightTicks = static_cast<float>(rightDiff) * (1 - mismatch);
+      const float mm = ((rightTicks + leftTicks) / 2) * scale;
+      const float dTheta = fuseHeading(((rightTicks - leftTicks) / 2) * turnScale * degreeToRadian, leftDiff != 0 || rightDiff != 0, dt);
+
+      integrate(chord(mm, dTheta), 0, dTheta);
+    }
+
+    if (recorder) {
+      const int gyroTicks = gyroParams.gyro ? lastGyroTicks : 0;
+      recorder->record(left.sensor && right.sensor ? OdomSample(timestamp, {{lastWheelTicks[0], lastWheelTicks[1], lastWheelTicks[2], gyroTicks}})
+                                   : OdomSample(timestamp, {{lastTicks[0], lastTicks[1], 0, gyroTicks}}));
+    }
+  }
+
+  float Odometry::fuseHeading(const float idTheta, const bool iisMoving, const float idt) {
+    if (!gyroParams.gyro)
+      return idTheta;
+
+    const int gyroTicks = gyroParams.gyro->get();
+    if (!hasGyroTicks) {
+      lastGyroTicks = gyroTicks;
+      gyroHeading = fusedHeading;
+      hasGyroTicks = true;
+    }
+
+    float gyroDTheta = static_cast<float>(gyroTicks - lastGyroTicks) * gyroParams.scale * degreeToRadian;
+    lastGyroTicks = gyroTicks;
+
+    //Anything the gyro reads after the wheels have been still for a few iterations is drift
+    stationaryCount = iisMoving ? 0 : stationaryCount + 1;
+    if (stationaryCount >= 3) {
+      stationaryAngle += gyroDTheta;
+      stationaryTime += idt;
+
+      //Forget old samples gradually so the estimate follows drift that changes with temperature
+      if (stationaryTime > gyroParams.biasWindow) {
+        stationaryAngle *= gyroParams.biasWindow / stationaryTime;
+        stationaryTime = gyroParams.biasWindow;
+      }
+
+      if (stationaryTime >= 1)
+        gyroBias = stationaryAngle / stationaryTime;
+    }
+
+    gyroDTheta -= gyroBias * idt;
+    gyroHeading += gyroDTheta;
+
+    if (estimator)
+      return idTheta; //The estimator weighs the gyro against the wheels itself
+
+    //Trust the gyro more the faster the robot turns. The rate comes from the wheels because the
+    //gyro only counts whole degrees, which would make the gain jump around
+    const float rate = idt > 0 ? std::fabs(idTheta) / idt * radianToDegree : 0;
+    const float gain = gyroParams.minGain + (gyroParams.maxGain - gyroParams.minGain) * std::fmin(rate / gyroParams.fullRate, 1.0f);
+
+    const float predicted = fusedHeading + idTheta;
+    const float fused = predicted + gain * (gyroHeading - predicted);
+    const float dTheta = fused - fusedHeading;
+    fusedHeading = fused;
+
+    return dTheta;
+  }
+
+  void Odometry::integrate(const float iforward, const float ilateral, const float idTheta) {
+    if (estimator) {
+      estimator->predict(iforward, ilateral, idTheta);
+      if (gyroParams.gyro)
+        estimator->correctGyro(gyroHeading * radianToDegree);
+      if (relocalizer)
+        relocalizer->step(estimator->getState(), estimator.get());
+
+      state = estimator->getState();
+      heading = state.theta * degreeToRadian;
+    } else {
+      //A chord of the arc the robot drove points halfway between the old and new headings
+      const float chordAngle = heading + idTheta / 2;
+      const float cosAngle = FastMath::cos(chordAngle);
+      const float sinAngle = FastMath::sin(chordAngle);
+
+      state.x += iforward * cosAngle - ilateral * sinAngle;
+      state.y += iforward * sinAngle + ilateral * cosAngle;
 
-      state.x += mm * std::cos(state.theta);
-      state.y += mm * std::sin(state.theta);
+      heading += idTheta;
+      if (heading > pi)
+        heading -= 2 * pi;
+      else if (heading <= -pi)
+        heading += 2 * pi;
 
+      state.theta = heading * radianToDegree;
+
+      if (relocalizer) {
+        const OdomState shift = relocalizer->step(state, nullptr);
+        state.x += shift.x;
+        state.y += shift.y;
+      }
+    }
+
+    published.write(state);
+    history.push(TimedOdomState(timestamp, state));
+  }
+
+  bool Odometry::lookup(const unsigned long itime, TimedOdomState& ostate) const {
+    TimedOdomState newer, older;
+    if (!history.get(0, newer))
+      return false;
+
+    if (static_cast<long>(itime - newer.timestamp) >= 0) {
+      ostate = newer;
+      return true;
+    }
+
+    for (std::size_t age = 1; history.get(age, older); age++) {
+      if (static_cast<long>(itime - older.timestamp) >= 0) {
+        const float span = static_cast<float>(newer.timestamp - older.timestamp);
+        const float t = span > 0 ? static_cast<float>(itime - older.timestamp) / span : 0;
+
+        //Interpolate the heading the short way around
+        float dTheta = newer.state.theta - older.state.theta;
+        if (dTheta > 180)
+          dTheta -= 360;
+        else if (dTheta < -180)
+          dTheta += 360;
+
+        float theta = older.state.theta + t * dTheta;
+        if (theta > 180)
+          theta -= 360;
+        else if (theta <= -180)
+          theta += 360;
+
+        ostate = TimedOdomState(itime, OdomState(older.state.x + t * (newer.state.x - older.state.x),
+                                                 older.state.y + t * (newer.state.y - older.state.y),
+                                                 theta));
+        return true;
+      }
+
+      newer = older;
+    }
+
+    ostate = newer; //Older than anything stored, so use the oldest state
+    return true;
+  }
+
+  OdomState Odometry::getStateAt(const unsigned long itime) const {
+    TimedOdomState out;
+    return lookup(itime, out) ? out.state : getState();
+  }
+
+  OdomState Odometry::getVelocity(const unsigned long iwindow) const {
+    TimedOdomState newest, past;
+    if (!history.get(0, newest) || !lookup(newest.timestamp - iwindow, past) || newest.timestamp == past.timestamp)
+      return OdomState();
+
+    const float dt = static_cast<float>(newest.timestamp - past.timestamp) / 1000000.0;
+
+    float dTheta = newest.state.theta - past.state.theta;
+    if (dTheta > 180)
+      dTheta -= 360;
+    else if (dTheta < -180)
+      dTheta += 360;
+
+    return OdomState((newest.state.x - past.state.x) / dt, (newest.state.y - past.state.y) / dt, dTheta / dt);
+  }
+
+  float Odometry::chord(const float iarc, const float idTheta) {
+    //sin(x) / x, using its series for small angles (one tick's worth of turning, usually) where
+    //dividing the table's absolute error by x would blow it up, and so we never divide by zero
+    const float halfDTheta = idTheta / 2;
+    if (std::fabs(halfDTheta) < 0.1) {
+      const float sq = halfDTheta * halfDTheta;
+      return iarc * (1 - sq / 6 * (1 - sq / 20));
+    }
+
+    return iarc * FastMath::sin(halfDTheta) / halfDTheta;
+  }
+
+  void Odometry::loop() {
+    unsigned long now = PAL::millis();
+
+    while (true) {
+      step();
       PAL::taskDelayUntil(&now, 15);
     }
   }
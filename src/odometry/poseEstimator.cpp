@@ -0,0 +1,260 @@
+#include <cmath>
+#include "odometry/poseEstimator.h"
+#include "util/fastMath.h"
+#include "util/mathUtil.h"
+
+namespace okapi {
+  namespace {
+    float wrap(float iangle) {
+      while (iangle > pi)
+        iangle -= 2 * pi;
+      while (iangle <= -pi)
+        iangle += 2 * pi;
+      return iangle;
+    }
+  }
+
+  PoseEstimator::PoseEstimator(const PoseEstimatorParams& iparams):
+    params(iparams),
+    x(0),
+    y(0),
+    theta(0),
+    gyroOffset(0),
+    covariance(),
+    hasGyroOffset(false),
+    lastGyroTime(0),
+    published(),
+    mutex(PAL::mutexCreate()) {}
+
+  void PoseEstimator::setParams(const PoseEstimatorParams& iparams) {
+    PAL::mutexTake(mutex, maxDelay);
+    params = iparams;
+    PAL::mutexGive(mutex);
+  }
+
+  void PoseEstimator::setState(const OdomState& istate, const float ixyStdDev, const float ithetaStdDev) {
+    PAL::mutexTake(mutex, maxDelay);
+
+    x = istate.x;
+    y = istate.y;
+    theta = wrap(istate.theta * degreeToRadian);
+
+    const float thetaStdDev = ithetaStdDev * degreeToRadian;
+    covariance = Matrix<4, 4>();
+    covariance(0, 0) = ixyStdDev * ixyStdDev;
+    covariance(1, 1) = ixyStdDev * ixyStdDev;
+    covariance(2, 2) = thetaStdDev * thetaStdDev;
+
+    hasGyroOffset = false;
+    publish();
+
+    PAL::mutexGive(mutex);
+  }
+
+  void PoseEstimator::predict(const float iforward, const float ilateral, const float idTheta) {
+    PAL::mutexTake(mutex, maxDelay);
+
+    //Same motion model as Odometry::integrate: the chord points halfway between the headings
+    const float chordAngle = theta + idTheta / 2;
+    const float cosAngle = FastMath::cos(chordAngle);
+    const float sinAngle = FastMath::sin(chordAngle);
+    const float dx = iforward * cosAngle - ilateral * sinAngle;
+    const float dy = iforward * sinAngle + ilateral * cosAngle;
+
+    x += dx;
+    y += dy;
+    theta = wrap(theta + idTheta);
+
+    //Heading error swings the displacement around, so it couples into x and y
+    Matrix<4, 4> jacobian = Matrix<4, 4>::identity();
+    jacobian(0, 2) = -dy;
+    jacobian(1, 2) = dx;
+
+    //Motion noise in the robot's frame, rotated into the odom frame
+    const float distance = std::fabs(iforward) + std::fabs(ilateral);
+    const float forwardVar = params.distanceVariance * std::fabs(iforward);
+    const float lateralVar = params.distanceVariance * std::fabs(ilateral);
+    const float thetaVar = params.turnVariance * degreeToRadian * std::fabs(idTheta) +
+                           params.driftVariance * degreeToRadian * degreeToRadian * distance;
+
+    Matrix<4, 4> noise;
+    noise(0, 0) = forwardVar * cosAngle * cosAngle + lateralVar * sinAngle * sinAngle;
+    noise(1, 1) = forwardVar * sinAngle * sinAngle + lateralVar * cosAngle * cosAngle;
+    noise(0, 1) = (forwardVar - lateralVar) * cosAngle * sinAngle;
+    noise(1, 0) = noise(0, 1);
+    noise(2, 2) = thetaVar;
+
+    covariance = jacobian * covariance * jacobian.transpose() + noise;
+    publish();
+
+    PAL::mutexGive(mutex);
+  }
+
+  bool PoseEstimator::correctHeading(const float itheta, const float istdDev) {
+    PAL::mutexTake(mutex, maxDelay);
+
+    Matrix<1, 4> jacobian;
+    jacobian(0, 2) = 1;
+    const float stdDev = istdDev * degreeToRadian;
+    const bool accepted = update(jacobian, wrap(itheta * degreeToRadian - theta), stdDev * stdDev);
+
+    PAL::mutexGive(mutex);
+    return accepted;
+  }
+
+  bool PoseEstimator::correctGyro(const float igyroHeading) {
+    PAL::mutexTake(mutex, maxDelay);
+
+    const float gyroHeading = igyroHeading * degreeToRadian;
+    const unsigned long now = PAL::micros();
+    bool accepted = true;
+
+    if (!hasGyroOffset) {
+      //The offset is exactly as uncertain as theta is right now, and moves with it
+      gyroOffset = theta - gyroHeading;
+      for (std::size_t i = 0; i < 3; i++) {
+        covariance(3, i) = covariance(2, i);
+        covariance(i, 3) = covariance(i, 2);
+      }
+      covariance(3, 3) = covariance(2, 2);
+      hasGyroOffset = true;
+    } else {
+      //The gyro wanders away from the true heading over time
+      const float dt = static_cast<float>(now - lastGyroTime) / 1000000.0;
+      covariance(3, 3) += params.gyroDriftVariance * degreeToRadian * degreeToRadian * dt;
+
+      Matrix<1, 4> jacobian;
+      jacobian(0, 2) = 1;
+      jacobian(0, 3) = -1;
+      const float stdDev = params.gyroStdDev * degreeToRadian;
+      accepted = update(jacobian, wrap(gyroHeading - (theta - gyroOffset)), stdDev * stdDev);
+    }
+
+    lastGyroTime = now;
+
+    PAL::mutexGive(mutex);
+    return accepted;
+  }
+
+  bool PoseEstimator::correctRange(const SensorMount& imount, const FieldSegment& iwall, const float irange, const float istdDev) {
+    if (iwall.invLengthSq <= 0)
+      return false;
+
+    const float normalX = iwall.normalX;
+    const float normalY = iwall.normalY;
+
+    PAL::mutexTake(mutex, maxDelay);
+
+    const float cosTheta = FastMath::cos(theta);
+    const float sinTheta = FastMath::sin(theta);
+    const float beamAngle = theta + imount.theta * degreeToRadian;
+    const float beamX = FastMath::cos(beamAngle);
+    const float beamY = FastMath::sin(beamAngle);
+
+    const float sensorX = x + imount.x * cosTheta - imount.y * sinTheta;
+    const float sensorY = y + imount.x * sinTheta + imount.y * cosTheta;
+
+    //Range along the beam to the wall's line is (offset - sensor . normal) / (beam . normal)
+    const float num = iwall.offset - (sensorX * normalX + sensorY * normalY);
+    const float den = beamX * normalX + beamY * normalY;
+
+    bool accepted = false;
+    if (std::fabs(den) >= 0.1) { //Nearly edge on, an ultrasonic beam reflects away
+      const float expected = num / den;
+      const float hitX = sensorX + expected * beamX - iwall.x1;
+      const float hitY = sensorY + expected * beamY - iwall.y1;
+      const float along = (hitX * iwall.dx + hitY * iwall.dy) * iwall.invLengthSq;
+
+      if (expected > 0 && along >= 0 && along <= 1) {
+        //Derivatives of the sensor position and beam direction with respect to theta
+        const float dSensorX = -imount.x * sinTheta - imount.y * cosTheta;
+        const float dSensorY = imount.x * cosTheta - imount.y * sinTheta;
+        const float dNum = -(dSensorX * normalX + dSensorY * normalY);
+        const float dDen = -beamY * normalX + beamX * normalY;
+
+        Matrix<1, 4> jacobian;
+        jacobian(0, 0) = -normalX / den;
+        jacobian(0, 1) = -normalY / den;
+        jacobian(0, 2) = (dNum * den - num * dDen) / (den * den);
+
+        accepted = update(jacobian, irange - expected, istdDev * istdDev);
+      }
+    }
+
+    PAL::mutexGive(mutex);
+    return accepted;
+  }
+
+  bool PoseEstimator::correctLine(const SensorMount& imount, const FieldSegment& iline, const float istdDev) {
+    if (iline.invLengthSq <= 0)
+      return false;
+
+    const float normalX = iline.normalX;
+    const float normalY = iline.normalY;
+
+    PAL::mutexTake(mutex, maxDelay);
+
+    const float cosTheta = FastMath::cos(theta);
+    const float sinTheta = FastMath::sin(theta);
+    const float sensorX = x + imount.x * cosTheta - imount.y * sinTheta - iline.x1;
+    const float sensorY = y + imount.x * sinTheta + imount.y * cosTheta - iline.y1;
+
+    bool accepted = false;
+    const float along = (sensorX * iline.dx + sensorY * iline.dy) * iline.invLengthSq;
+    if (along >= 0 && along <= 1) {
+      //The sensor is on the line, so its signed distance from the line is measured as 0
+      const float distance = sensorX * normalX + sensorY * normalY;
+
+      Matrix<1, 4> jacobian;
+      jacobian(0, 0) = normalX;
+      jacobian(0, 1) = normalY;
+      jacobian(0, 2) = (-imount.x * sinTheta - imount.y * cosTheta) * normalX + (imount.x * cosTheta - imount.y * sinTheta) * normalY;
+
+      accepted = update(jacobian, -distance, istdDev * istdDev);
+    }
+
+    PAL::mutexGive(mutex);
+    return accepted;
+  }
+
+  bool PoseEstimator::update(const Matrix<1, 4>& ijacobian, const float iinnovation, const float ivariance) {
+    const Matrix<4, 1> crossCov = covariance * ijacobian.transpose();
+    const float innovationVar = (ijacobian * crossCov)(0, 0) + ivariance;
+
+    if (innovationVar <= 0 || iinnovation * iinnovation > params.gate * params.gate * innovationVar)
+      return false;
+
+    const Matrix<4, 1> gain = crossCov * (1 / innovationVar);
+
+    x += gain(0, 0) * iinnovation;
+    y += gain(1, 0) * iinnovation;
+    theta = wrap(theta + gain(2, 0) * iinnovation);
+    gyroOffset += gain(3, 0) * iinnovation;
+
+    //P - K H P is an outer product here since H P is just crossCov transposed. Mirror it so
+    //rounding never makes the covariance lopsided
+    covariance = covariance - gain * crossCov.transpose();
+    for (std::size_t i = 0; i < 4; i++) {
+      for (std::size_t j = i + 1; j < 4; j++) {
+        const float mean = (covariance(i, j) + covariance(j, i)) / 2;
+        covariance(i, j) = mean;
+        covariance(j, i) = mean;
+      }
+    }
+
+    publish();
+    return true;
+  }
+
+  void PoseEstimator::publish() {
+    PoseEstimate& out = published.getBack();
+    out.state = OdomState(x, y, theta * radianToDegree);
+
+    //Report the pose's block, with theta's row and column in degrees
+    for (std::size_t i = 0; i < 3; i++)
+      for (std::size_t j = 0; j < 3; j++)
+        out.covariance(i, j) = covariance(i, j) * (i == 2 ? radianToDegree : 1) * (j == 2 ? radianToDegree : 1);
+
+    published.publish();
+  }
+}
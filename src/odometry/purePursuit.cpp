@@ -0,0 +1,113 @@
+#include <cmath>
+#include "odometry/purePursuit.h"
+#include "util/mathUtil.h"
+#include "util/fastMath.h"
+
+namespace okapi {
+  constexpr std::size_t PurePursuit::maxWaypoints;
+
+  bool PurePursuit::setPath(const OdomState& istart, std::initializer_list<Waypoint> iwaypoints) {
+    path[0] = Waypoint(istart.x, istart.y);
+    count = 1;
+
+    for (const Waypoint& point : iwaypoints) {
+      if (count >= maxWaypoints)
+        return false;
+      path[count++] = point;
+    }
+
+    segment = 0;
+    segmentFraction = 0;
+    curvature = 0;
+    return true;
+  }
+
+  Waypoint PurePursuit::findLookahead(const OdomState& istate) {
+    const Waypoint& last = path[count - 1];
+    const float lastXDiff = last.x - istate.x;
+    const float lastYDiff = last.y - istate.y;
+
+    //Near the end, steer straight at the last waypoint
+    if (lastXDiff * lastXDiff + lastYDiff * lastYDiff <= params.lookahead * params.lookahead) {
+      segment = count - 2;
+      segmentFraction = 1;
+      return last;
+    }
+
+    //Intersect the lookahead circle with each segment from the current one on and keep the
+    //furthest intersection along the path, stopping at the first segment which misses the circle
+    bool isFound = false;
+    for (std::size_t i = segment; i + 1 < count; i++) {
+      const float dx = path[i + 1].x - path[i].x;
+      const float dy = path[i + 1].y - path[i].y;
+      const float fx = path[i].x - istate.x;
+      const float fy = path[i].y - istate.y;
+
+      const float a = dx * dx + dy * dy;
+      const float b = 2 * (fx * dx + fy * dy);
+      const float c = fx * fx + fy * fy - params.lookahead * params.lookahead;
+      const float discriminant = b * b - 4 * a * c;
+
+      if (a <= 0 || discriminant < 0) {
+        if (isFound)
+          break;
+        continue;
+      }
+
+      const float t = (-b + FastMath::sqrt(discriminant)) / (2 * a); //Forward intersection
+      if (t >= 0 && t <= 1 && (i > segment || t >= segmentFraction)) {
+        segment = i;
+        segmentFraction = t;
+        isFound = true;
+      } else if (isFound) {
+        break;
+      }
+    }
+
+    const Waypoint& start = path[segment];
+    const Waypoint& end = path[segment + 1];
+    return Waypoint(start.x + segmentFraction * (end.x - start.x), start.y + segmentFraction * (end.y - start.y));
+  }
+
+  PurePursuitOutput PurePursuit::step(const OdomState& istate) {
+    if (count < 2)
+      return PurePursuitOutput(0, 0, true);
+
+    const Waypoint& last = path[count - 1];
+    const float remaining = FastMath::sqrt((last.x - istate.x) * (last.x - istate.x) + (last.y - istate.y) * (last.y - istate.y));
+    if (remaining <= params.endThreshold)
+      return PurePursuitOutput(0, 0, true);
+
+    //Once on the last segment, a robot which went past the last waypoint outside the threshold
+    //would find the lookahead point behind it and circle back forever at minimum power, so being
+    //past the end along that segment also finishes the path
+    const Waypoint& secondLast = path[count - 2];
+    if (segment + 2 >= count && (istate.x - last.x) * (last.x - secondLast.x) + (istate.y - last.y) * (last.y - secondLast.y) >= 0)
+      return PurePursuitOutput(0, 0, true);
+
+    const Waypoint target = findLookahead(istate);
+
+    //Lookahead point in the robot's frame (x forward, y left)
+    const float theta = istate.theta * degreeToRadian;
+    const float xDiff = target.x - istate.x;
+    const float yDiff = target.y - istate.y;
+    const float localY = -FastMath::sin(theta) * xDiff + FastMath::cos(theta) * yDiff;
+    const float distSq = xDiff * xDiff + yDiff * yDiff;
+
+    //Arc through the robot and the lookahead point, tangent to the robot's heading
+    curvature = distSq > 0 ? 2 * localY / distSq : 0;
+
+    float power = params.maxPower;
+    if (params.turnPowerGain > 0 && std::fabs(curvature) > 0)
+      power = std::fmin(power, params.turnPowerGain / std::fabs(curvature));
+
+    //Slow down over the last lookahead distance so the robot stops on the last waypoint
+    if (remaining < params.lookahead)
+      power = std::fmin(power, params.maxPower * remaining / params.lookahead);
+
+    power = std::fmax(power, params.minPower);
+
+    //Counterclockwise curvature needs the right side faster than the left
+    return PurePursuitOutput(power, -power * curvature * params.trackWidth / 2, false);
+  }
+}
@@ -0,0 +1,101 @@
+#include <cmath>
+#include "odometry/relocalizer.h"
+#include "util/fastMath.h"
+#include "util/mathUtil.h"
+#include "PAL/PAL.h"
+
+namespace okapi {
+  constexpr std::size_t Relocalizer::maxSensors;
+
+  Relocalizer::Relocalizer(const FieldMap& imap, const RelocalizerParams& iparams):
+    map(imap),
+    params(iparams),
+    count(0),
+    lastRun(0),
+    hasRun(false),
+    accepted(0),
+    rejected(0) {}
+
+  bool Relocalizer::addSensor(const std::shared_ptr<RangeFinder>& isensor, const SensorMount& imount) {
+    if (count >= maxSensors)
+      return false;
+
+    sensors[count].sensor = isensor;
+    sensors[count].mount = imount;
+    count++;
+    return true;
+  }
+
+  bool Relocalizer::getExpectedRange(const OdomState& istate, const SensorMount& imount, RaycastHit& ohit) const {
+    const float theta = istate.theta * degreeToRadian;
+    const float cosTheta = FastMath::cos(theta);
+    const float sinTheta = FastMath::sin(theta);
+
+    return map.raycast(istate.x + imount.x * cosTheta - imount.y * sinTheta,
+                       istate.y + imount.x * sinTheta + imount.y * cosTheta,
+                       theta + imount.theta * degreeToRadian,
+                       ohit);
+  }
+
+  OdomState Relocalizer::step(const OdomState& istate, PoseEstimator *iestimator) {
+    OdomState shift;
+
+    const unsigned long now = PAL::millis();
+    if (count == 0 || (hasRun && now - lastRun < params.period))
+      return shift;
+
+    lastRun = now;
+    hasRun = true;
+
+    for (std::size_t i = 0; i < count; i++) {
+      const int reading = sensors[i].sensor->getFiltered();
+      RaycastHit hit;
+
+      if (reading <= 0 || !getExpectedRange(istate, sensors[i].mount, hit) || hit.incidence < params.minIncidence) {
+        rejected++;
+        continue;
+      }
+
+      const float range = static_cast<float>(reading) * 10; //RangeFinder reads cm
+      const float error = range - hit.range;
+      if (std::fabs(error) > params.agreement) {
+        rejected++;
+        continue;
+      }
+
+      if (iestimator) {
+        if (iestimator->correctRange(sensors[i].mount, map.getWall(hit.wall), range, params.stdDev))
+          accepted++;
+        else
+          rejected++;
+        continue;
+      }
+
+      //Reading too long means the robot is further from the wall than we think, so move it
+      //straight away from the wall by the part of the error along the wall's normal
+      float correction = params.gain * error * hit.incidence;
+      if (correction > params.maxCorrection)
+        correction = params.maxCorrection;
+      else if (correction < -params.maxCorrection)
+        correction = -params.maxCorrection;
+
+      //The ray points into the wall, so the unit normal toward the robot is opposite the ray's
+      //component along it
+      const FieldSegment& wall = map.getWall(hit.wall);
+      float normalX = wall.normalX;
+      float normalY = wall.normalY;
+
+      const float rayAngle = (istate.theta + sensors[i].mount.theta) * degreeToRadian;
+      if (FastMath::cos(rayAngle) * normalX + FastMath::sin(rayAngle) * normalY > 0) {
+        normalX = -normalX;
+        normalY = -normalY;
+      }
+
+      shift.x += correction * normalX;
+      shift.y += correction * normalY;
+      accepted++;
+    }
+
+    return shift;
+  }
+}
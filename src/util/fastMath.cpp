@@ -0,0 +1,151 @@
+#include "util/fastMath.h"
+
+namespace okapi {
+  constexpr int FastMath::tableSize;
+  constexpr float FastMath::tableUnitsPerRadian;
+
+  const float FastMath::sinTable[FastMath::tableSize + 1] = {
+    0.0, 0.00613588465, 0.0122715383, 0.0184067299, 0.0245412285, 0.0306748032, 0.0368072229,
+    0.0429382569, 0.0490676743, 0.0551952443, 0.0613207363, 0.0674439196, 0.0735645636,
+    0.079682438, 0.0857973123, 0.0919089565, 0.0980171403, 0.104121634, 0.110222207, 0.116318631,
+    0.122410675, 0.128498111, 0.134580709, 0.140658239, 0.146730474, 0.152797185, 0.158858143,
+    0.16491312, 0.170961889, 0.17700422, 0.183039888, 0.189068664, 0.195090322, 0.201104635,
+    0.207111376, 0.21311032, 0.21910124, 0.225083911, 0.231058108, 0.237023606, 0.24298018,
+    0.248927606, 0.25486566, 0.260794118, 0.266712757, 0.272621355, 0.278519689, 0.284407537,
+    0.290284677, 0.296150888, 0.302005949, 0.30784964, 0.31368174, 0.319502031, 0.325310292,
+    0.331106306, 0.336889853, 0.342660717, 0.34841868, 0.354163525, 0.359895037, 0.365612998,
+    0.371317194, 0.37700741, 0.382683432, 0.388345047, 0.39399204, 0.3996242, 0.405241314,
+    0.410843171, 0.41642956, 0.422000271, 0.427555093, 0.433093819, 0.438616239, 0.444122145,
+    0.44961133, 0.455083587, 0.460538711, 0.465976496, 0.471396737, 0.47679923, 0.482183772,
+    0.48755016, 0.492898192, 0.498227667, 0.503538384, 0.508830143, 0.514102744, 0.51935599,
+    0.524589683, 0.529803625, 0.53499762, 0.540171473, 0.545324988, 0.550457973, 0.555570233,
+    0.560661576, 0.565731811, 0.570780746, 0.575808191, 0.580813958, 0.585797857, 0.590759702,
+    0.595699304, 0.600616479, 0.605511041, 0.610382806, 0.615231591, 0.620057212, 0.624859488,
+    0.629638239, 0.634393284, 0.639124445, 0.643831543, 0.648514401, 0.653172843, 0.657806693,
+    0.662415778, 0.666999922, 0.671558955, 0.676092704, 0.680600998, 0.685083668, 0.689540545,
+    0.693971461, 0.698376249, 0.702754744, 0.707106781, 0.711432196, 0.715730825, 0.720002508,
+    0.724247083, 0.72846439, 0.732654272, 0.736816569, 0.740951125, 0.745057785, 0.749136395,
+    0.753186799, 0.757208847, 0.761202385, 0.765167266, 0.769103338, 0.773010453, 0.776888466,
+    0.780737229, 0.784556597, 0.788346428, 0.792106577, 0.795836905, 0.799537269, 0.803207531,
+    0.806847554, 0.810457198, 0.81403633, 0.817584813, 0.821102515, 0.824589303, 0.828045045,
+    0.831469612, 0.834862875, 0.838224706, 0.841554977, 0.844853565, 0.848120345, 0.851355193,
+    0.854557988, 0.85772861, 0.860866939, 0.863972856, 0.867046246, 0.870086991, 0.873094978,
+    0.876070094, 0.879012226, 0.881921264, 0.884797098, 0.88763962, 0.890448723, 0.893224301,
+    0.89596625, 0.898674466, 0.901348847, 0.903989293, 0.906595705, 0.909167983, 0.911706032,
+    0.914209756, 0.91667906, 0.919113852, 0.921514039, 0.923879533, 0.926210242, 0.92850608,
+    0.930766961, 0.932992799, 0.93518351, 0.937339012, 0.939459224, 0.941544065, 0.943593458,
+    0.945607325, 0.947585591, 0.949528181, 0.951435021, 0.95330604, 0.955141168, 0.956940336,
+    0.958703475, 0.960430519, 0.962121404, 0.963776066, 0.965394442, 0.966976471, 0.968522094,
+    0.970031253, 0.971503891, 0.972939952, 0.974339383, 0.97570213, 0.977028143, 0.978317371,
+    0.979569766, 0.98078528, 0.981963869, 0.983105487, 0.984210092, 0.985277642, 0.986308097,
+    0.987301418, 0.988257568, 0.98917651, 0.99005821, 0.990902635, 0.991709754, 0.992479535,
+    0.993211949, 0.99390697, 0.994564571, 0.995184727, 0.995767414, 0.996312612, 0.996820299,
+    0.997290457, 0.997723067, 0.998118113, 0.998475581, 0.998795456, 0.999077728, 0.999322385,
+    0.999529418, 0.999698819, 0.999830582, 0.999924702, 0.999981175, 1.0
+  };
+
+  const float FastMath::atanTable[FastMath::tableSize + 1] = {
+    0.0, 0.00390623013, 0.00781234106, 0.0117182136, 0.0156237286, 0.019528767, 0.0234332099,
+    0.0273369383, 0.0312398334, 0.0351417768, 0.03904265, 0.0429423347, 0.0468407129, 0.0507376669,
+    0.0546330792, 0.0585268326, 0.06241881, 0.0663088949, 0.0701969711, 0.0740829225, 0.0779666338,
+    0.0818479898, 0.0857268758, 0.0896031775, 0.0934767812, 0.0973475735, 0.101215442, 0.105080273,
+    0.108941957, 0.112800381, 0.116655435, 0.12050701, 0.124354995, 0.128199281, 0.132039762,
+    0.135876328, 0.139708874, 0.143537294, 0.147361481, 0.151181332, 0.154996742, 0.158807608,
+    0.162613829, 0.166415301, 0.170211925, 0.174003601, 0.177790229, 0.181571711, 0.18534795,
+    0.189118849, 0.192884312, 0.196644245, 0.200398554, 0.204147145, 0.207889927, 0.211626809,
+    0.2153577, 0.219082511, 0.222801154, 0.226513541, 0.230219587, 0.233919206, 0.237612314,
+    0.241298827, 0.244978663, 0.248651741, 0.252317981, 0.255977303, 0.259629629, 0.263274883,
+    0.266912988, 0.270543868, 0.274167451, 0.277783663, 0.281392433, 0.284993689, 0.288587362,
+    0.292173383, 0.295751686, 0.299322203, 0.302884868, 0.306439619, 0.309986391, 0.313525123,
+    0.317055753, 0.320578222, 0.32409247, 0.327598441, 0.331096077, 0.334585322, 0.338066123,
+    0.341538425, 0.345002177, 0.348457327, 0.351903825, 0.355341622, 0.35877067, 0.362190922,
+    0.365602332, 0.369004855, 0.372398447, 0.375783065, 0.379158669, 0.382525217, 0.385882669,
+    0.389230988, 0.392570135, 0.395900074, 0.39922077, 0.402532187, 0.405834293, 0.409127055,
+    0.412410442, 0.415684422, 0.418948967, 0.422204048, 0.425449637, 0.428685708, 0.431912235,
+    0.435129194, 0.43833656, 0.441534311, 0.444722424, 0.447900879, 0.451069656, 0.454228735,
+    0.457378099, 0.460517729, 0.463647609, 0.466767724, 0.469878058, 0.472978598, 0.47606933,
+    0.479150243, 0.482221324, 0.485282564, 0.488333951, 0.491375478, 0.494407135, 0.497428916,
+    0.500440813, 0.503442821, 0.506434934, 0.509417149, 0.51238946, 0.515351866, 0.518304364,
+    0.521246951, 0.524179629, 0.527102395, 0.530015251, 0.532918198, 0.535811238, 0.538694373,
+    0.541567605, 0.54443094, 0.547284381, 0.550127933, 0.552961602, 0.555785394, 0.558599315,
+    0.561403374, 0.564197577, 0.566981934, 0.569756453, 0.572521145, 0.575276018, 0.578021084,
+    0.580756354, 0.583481839, 0.586197551, 0.588903504, 0.59159971, 0.594286183, 0.596962937,
+    0.599629987, 0.602287346, 0.604935031, 0.607573058, 0.610201443, 0.612820202, 0.615429353,
+    0.618028912, 0.620618899, 0.62319933, 0.625770225, 0.628331602, 0.630883482, 0.633425883,
+    0.635958826, 0.63848233, 0.640996418, 0.643501109, 0.645996425, 0.648482388, 0.650959019,
+    0.653426341, 0.655884377, 0.658333148, 0.660772679, 0.663202993, 0.665624112, 0.668036062,
+    0.670438866, 0.672832548, 0.675217133, 0.677592646, 0.679959111, 0.682316555, 0.684665002,
+    0.687004478, 0.68933501, 0.691656622, 0.693969341, 0.696273194, 0.698568208, 0.700854408,
+    0.703131822, 0.705400477, 0.7076604, 0.709911618, 0.71215416, 0.714388052, 0.716613323,
+    0.71883, 0.721038111, 0.723237685, 0.725428749, 0.727611333, 0.729785464, 0.731951171,
+    0.734108483, 0.736257429, 0.738398037, 0.740530337, 0.742654356, 0.744770126, 0.746877674,
+    0.748977029, 0.751068222, 0.753151281, 0.755226236, 0.757293116, 0.759351951, 0.76140277,
+    0.763445603, 0.765480479, 0.767507428, 0.76952648, 0.771537665, 0.773541012, 0.77553655,
+    0.77752431, 0.779504322, 0.781476615, 0.783441219, 0.785398163
+  };
+
+  float FastMath::sinTableUnits(const float iunits, const Accuracy iaccuracy) {
+    //Split into a whole number of table steps and the fraction of a step past it, rounding
+    //toward negative infinity so negative angles land in the right quadrant
+    int whole = static_cast<int>(iunits);
+    if (static_cast<float>(whole) > iunits)
+      whole--;
+
+    float frac = iunits - static_cast<float>(whole);
+    if (iaccuracy == Accuracy::coarse && frac >= 0.5) {
+      whole++;
+      frac = 0;
+    }
+
+    const unsigned int step = static_cast<unsigned int>(whole) % (4 * tableSize);
+    const unsigned int quadrant = step / tableSize;
+    const unsigned int index = step % tableSize;
+
+    //Quadrants 1 and 3 run the quarter wave backwards; quadrants 2 and 3 are negative
+    float from, to;
+    if (quadrant & 1) {
+      from = sinTable[tableSize - index];
+      to = sinTable[tableSize - index - 1];
+    } else {
+      from = sinTable[index];
+      to = sinTable[index + 1];
+    }
+
+    const float out = iaccuracy == Accuracy::fine ? from + frac * (to - from) : from;
+    return quadrant & 2 ? -out : out;
+  }
+
+  float FastMath::atanUnit(const float iratio, const Accuracy iaccuracy) {
+    const float units = iratio * tableSize;
+    const int index = static_cast<int>(units);
+
+    if (index >= tableSize)
+      return atanTable[tableSize];
+
+    if (iaccuracy == Accuracy::coarse)
+      return atanTable[units - static_cast<float>(index) >= 0.5 ? index + 1 : index];
+
+    const float from = atanTable[index];
+    return from + (units - static_cast<float>(index)) * (atanTable[index + 1] - from);
+  }
+
+  float FastMath::atan2(const float iy, const float ix, const Accuracy iaccuracy) {
+    const float absX = ix < 0 ? -ix : ix;
+    const float absY = iy < 0 ? -iy : iy;
+
+    if (absX == 0 && absY == 0)
+      return 0;
+
+    //Reduce to an angle in [0, pi / 4] so the table argument is in [0, 1]
+    float angle;
+    if (absY <= absX)
+      angle = atanUnit(absY / absX, iaccuracy);
+    else
+      angle = 1.57079632679489661923 - atanUnit(absX / absY, iaccuracy);
+
+    if (ix < 0)
+      angle = 3.14159265358979323846 - angle;
+
+    return iy < 0 ? -angle : angle;
+  }
+}
@@ -2,9 +2,9 @@ LIBNAME=okapilib
 VERSION=0.5.1
 
 # extra files (like header files)
-TEMPLATEFILES = include/main.h include/device/motor.h include/device/button.h include/device/ime.h include/device/potentiometer.h include/device/quadEncoder.h include/device/rangeFinder.h include/device/rotarySensor.h include/chassis/chassisModel.h include/chassis/odomChassisController.h include/chassis/chassisController.h include/API.h include/util/timer.h include/util/mathUtil.h include/odometry/odomMath.h include/odometry/odometry.h include/filter/filter.h include/filter/emaFilter.h include/filter/avgFilter.h include/filter/demaFilter.h include/control/pid.h include/control/genericController.h include/control/velMath.h include/control/nsPid.h include/control/velPid.h include/control/controlObject.h
+TEMPLATEFILES = include/main.h include/PAL/PAL.h include/device/motor.h include/device/button.h include/device/ime.h include/device/potentiometer.h include/device/quadEncoder.h include/device/edgeEncoder.h include/device/rangeFinder.h include/device/rotarySensor.h include/device/gyroscope.h include/device/sensorSampler.h include/chassis/chassisModel.h include/chassis/odomChassisController.h include/chassis/chassisController.h include/API.h include/util/timer.h include/util/doubleBuffer.h include/util/historyBuffer.h include/util/mathUtil.h include/util/fastMath.h include/util/matrix.h include/util/spscQueue.h include/odometry/odomMath.h include/odometry/odometry.h include/odometry/purePursuit.h include/odometry/poseEstimator.h include/odometry/fieldMap.h include/odometry/relocalizer.h include/odometry/odomCalibrator.h include/odometry/odomRecorder.h include/filter/filter.h include/filter/emaFilter.h include/filter/avgFilter.h include/filter/demaFilter.h include/control/pid.h include/control/fixedPid.h include/control/genericController.h include/control/velMath.h include/control/nsPid.h include/control/velPid.h include/control/flywheelController.h include/control/feedforwardVelController.h include/control/controlObject.h include/control/controlLoopScheduler.h include/control/motionProfile.h
 # basename of the source files that should be archived
-TEMPLATEOBJS = _bin_auto _bin_chassis_chassisController _bin_chassis_odomChassisController _bin_control_nsPid _bin_control_pid _bin_control_velMath _bin_control_velPid _bin_init _bin_odometry_odometry _bin_odometry_odomMath _bin_opcontrol _bin_util_timer
+TEMPLATEOBJS = _bin_auto _bin_chassis_chassisController _bin_chassis_odomChassisController _bin_control_controlLoopScheduler _bin_control_feedforwardVelController _bin_control_flywheelController _bin_control_motionProfile _bin_control_nsPid _bin_control_pid _bin_control_velMath _bin_control_velPid _bin_device_edgeEncoder _bin_device_sensorSampler _bin_init _bin_odometry_fieldMap _bin_odometry_odomCalibrator _bin_odometry_odometry _bin_odometry_odomMath _bin_odometry_odomRecorder _bin_odometry_poseEstimator _bin_odometry_purePursuit _bin_odometry_relocalizer _bin_opcontrol _bin_util_fastMath _bin_util_timer
 
 TEMPLATE=$(ROOT)/$(LIBNAME)-template
 
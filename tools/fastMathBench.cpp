@@ -0,0 +1,116 @@
+/**
+ * Times FastMath's sin, cos, atan2, and invSqrt against libm, and checks their worst case error
+ * at both accuracies over a dense sweep of inputs. Build it with "make fastmathbench". Host times
+ * only show the relative cost; on the Cortex libm goes through soft-float and the gap is larger.
+ */
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include "util/fastMath.h"
+
+using namespace okapi;
+
+namespace {
+  using Accuracy = FastMath::Accuracy;
+
+  constexpr int sweepPoints = 1000000;
+  constexpr int timingPasses = 20;
+  constexpr double pi = 3.14159265358979323846;
+
+  /**
+   * Worst case errors the FastMath docs promise, with a little headroom for float rounding
+   */
+  constexpr double fineLimit = 1e-5;
+  constexpr double coarseLimit = 5e-3;
+
+  template<typename F>
+  double timeLoop(const std::vector<float>& ix, const std::vector<float>& iy, F&& ibody) {
+    volatile float sink = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < timingPasses; pass++) {
+      float sum = 0;
+      for (std::size_t i = 0; i < ix.size(); i++)
+        sum += ibody(ix[i], iy[i]);
+      sink = sink + sum;
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (timingPasses * static_cast<double>(ix.size()));
+  }
+
+  /**
+   * Largest error of ifast against the double precision iexact over the sweep; relative if
+   * irelative, absolute otherwise
+   */
+  template<typename Fast, typename Exact>
+  double maxError(const std::vector<float>& ix, const std::vector<float>& iy, Fast&& ifast, Exact&& iexact, const bool irelative) {
+    double worst = 0;
+    for (std::size_t i = 0; i < ix.size(); i++) {
+      const double exact = iexact(static_cast<double>(ix[i]), static_cast<double>(iy[i]));
+      double error = std::fabs(static_cast<double>(ifast(ix[i], iy[i])) - exact);
+      if (irelative)
+        error /= std::fabs(exact);
+      worst = std::fmax(worst, error);
+    }
+    return worst;
+  }
+
+  bool passed = true;
+
+  template<typename Fast, typename Lib, typename Exact>
+  void check(const char* iname, const std::vector<float>& ix, const std::vector<float>& iy, Fast&& ifast, Lib&& ilib, Exact&& iexact, const bool irelative) {
+    const double libTime = timeLoop(ix, iy, ilib);
+    const double fineTime = timeLoop(ix, iy, [&](const float x, const float y) { return ifast(x, y, Accuracy::fine); });
+    const double coarseTime = timeLoop(ix, iy, [&](const float x, const float y) { return ifast(x, y, Accuracy::coarse); });
+
+    const double fineError = maxError(ix, iy, [&](const float x, const float y) { return ifast(x, y, Accuracy::fine); }, iexact, irelative);
+    const double coarseError = maxError(ix, iy, [&](const float x, const float y) { return ifast(x, y, Accuracy::coarse); }, iexact, irelative);
+
+    std::printf("%-8s libm %5.1f ns | fine %5.1f ns, max error %.2e | coarse %5.1f ns, max error %.2e\n", iname, libTime, fineTime, fineError, coarseTime, coarseError);
+
+    if (fineError > fineLimit || coarseError > coarseLimit) {
+      std::printf("FAIL: %s is less accurate than documented\n", iname);
+      passed = false;
+    }
+  }
+}
+
+int main() {
+  std::vector<float> angles(sweepPoints), xs(sweepPoints), ys(sweepPoints), positives(sweepPoints), unused(sweepPoints);
+
+  for (int i = 0; i < sweepPoints; i++) {
+    const double t = static_cast<double>(i) / (sweepPoints - 1);
+
+    //Several turns either way, which is as far as odometry headings wander before wrapping
+    angles[i] = static_cast<float>((t * 2 - 1) * 4 * pi);
+
+    //Points on circles of radius 0.001 to 10 around the origin, at every heading
+    const double radius = std::pow(10.0, static_cast<double>(i % 5 - 3));
+    xs[i] = static_cast<float>(radius * std::cos(t * 2 * pi - pi));
+    ys[i] = static_cast<float>(radius * std::sin(t * 2 * pi - pi));
+
+    //Eight decades of magnitude, covering every mantissa many times over
+    positives[i] = static_cast<float>(std::pow(10.0, t * 8 - 4));
+  }
+
+  check("sin", angles, unused,
+        [](const float x, float, const Accuracy a) { return FastMath::sin(x, a); },
+        [](const float x, float) { return std::sin(x); },
+        [](const double x, double) { return std::sin(x); }, false);
+
+  check("cos", angles, unused,
+        [](const float x, float, const Accuracy a) { return FastMath::cos(x, a); },
+        [](const float x, float) { return std::cos(x); },
+        [](const double x, double) { return std::cos(x); }, false);
+
+  check("atan2", xs, ys,
+        [](const float x, const float y, const Accuracy a) { return FastMath::atan2(y, x, a); },
+        [](const float x, const float y) { return std::atan2(y, x); },
+        [](const double x, const double y) { return std::atan2(y, x); }, false);
+
+  check("invSqrt", positives, unused,
+        [](const float x, float, const Accuracy a) { return FastMath::invSqrt(x, a); },
+        [](const float x, float) { return 1 / std::sqrt(x); },
+        [](const double x, double) { return 1 / std::sqrt(x); }, true);
+
+  return passed ? 0 : 1;
+}
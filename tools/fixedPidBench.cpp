@@ -0,0 +1,99 @@
+/**
+ * Times FixedPid against the float Pid on the same closed loop, and checks that they agree.
+ * Build it with "make fixedpidbench". Host times only show the relative cost of the two; on the
+ * Cortex the float Pid goes through soft-float routines and the gap is much larger.
+ */
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include "PAL/simPAL.h"
+#include "control/fixedPid.h"
+#include "control/pid.h"
+
+using namespace okapi;
+
+namespace {
+  constexpr int iterations = 200000;
+  constexpr int sampleTime = 15;
+
+  /**
+   * First order plant driven by the controller, so both controllers see realistic readings
+   */
+  class Plant {
+  public:
+    Plant():
+      position(0),
+      velocity(0) {}
+
+    int step(const float ipower) {
+      velocity += (ipower * 0.5f - velocity) * 0.1f;
+      position += velocity;
+      return static_cast<int>(position);
+    }
+
+    float position, velocity;
+  };
+
+  template<typename F>
+  double timeLoop(F&& ibody) {
+    SimPAL::reset();
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+      PAL::delayMicroseconds(sampleTime * 1000);
+      ibody(i);
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+  }
+}
+
+int main() {
+  //The targets step around so the integral and derivative terms stay busy
+  auto target = [](const int i) { return (i / 200) % 2 == 0 ? 1000 : -500; };
+  volatile int sink = 0;
+
+  const double baseline = timeLoop([&](const int i) { sink = sink + target(i); });
+
+  Pid floatPid(0.4, 0.05, 0.02);
+  Plant floatPlant;
+  int floatReading = 0;
+  const double floatTime = timeLoop([&](const int i) {
+    floatPid.setTarget(static_cast<float>(target(i)));
+    floatReading = floatPlant.step(floatPid.step(static_cast<float>(floatReading)));
+  });
+
+  FixedPid<> fixedPid(0.4, 0.05, 0.02);
+  Plant fixedPlant;
+  int fixedReading = 0;
+  const double fixedTime = timeLoop([&](const int i) {
+    fixedPid.setTargetInt(target(i));
+    fixedReading = fixedPlant.step(static_cast<float>(fixedPid.stepInt(fixedReading)));
+  });
+
+  //Replay the same readings through both and compare outputs
+  SimPAL::reset();
+  Pid checkFloat(0.4, 0.05, 0.02);
+  FixedPid<> checkFixed(0.4, 0.05, 0.02);
+  Plant checkPlant;
+  int reading = 0;
+  float maxDiff = 0;
+  for (int i = 0; i < 20000; i++) {
+    PAL::delayMicroseconds(sampleTime * 1000);
+    checkFloat.setTarget(static_cast<float>(target(i)));
+    checkFixed.setTargetInt(target(i));
+    const float a = checkFloat.step(static_cast<float>(reading));
+    const float b = checkFixed.step(static_cast<float>(reading));
+    maxDiff = std::fmax(maxDiff, std::fabs(a - b));
+    reading = checkPlant.step(a);
+  }
+
+  std::printf("%d steps, clock and loop overhead %.1f ns per step\n", iterations, baseline);
+  std::printf("Pid       %7.1f ns per step\n", floatTime - baseline);
+  std::printf("FixedPid  %7.1f ns per step\n", fixedTime - baseline);
+  std::printf("max output difference %.4f\n", maxDiff);
+
+  if (maxDiff > 0.5f || fixedPid.hasLostGain()) {
+    std::printf("FAIL: FixedPid does not match Pid\n");
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,84 @@
+/**
+ * Checks Odometry against a simulated ground-truth trajectory at 5, 10, and 15 ms update
+ * periods. The robot drives at 600 mm/s with a sinusoidal turn rate for 20 s on 3600 tick
+ * encoders, which are fine enough that the error is mostly down to the integration. Build and run
+ * it with "make odombench"; it fails if the error grows past what exact arc integration gives.
+ */
+#include <cmath>
+#include <cstdio>
+#include "PAL/simPAL.h"
+#include "odometry/odometry.h"
+#include "util/mathUtil.h"
+
+using namespace okapi;
+
+namespace {
+  constexpr double wheelCircumference = 4 * 25.4 * 3.14159265358979; //mm
+  constexpr double track = 300; //mm
+  constexpr double ticksPerRev = 3600;
+  constexpr double speed = 600; //mm/s
+  constexpr unsigned long duration = 20000; //ms
+  constexpr unsigned long plantPeriod = 100; //us
+
+  class Result {
+  public:
+    double maxError, finalError, headingError;
+  };
+
+  Result run(const unsigned long iperiod) {
+    SimPAL::reset();
+
+    const double mmPerTick = wheelCircumference / ticksPerRev;
+    double x = 0, y = 0, theta = 0, leftMM = 0, rightMM = 0, time = 0;
+
+    //Ground truth, integrated as exact arcs every 100 us
+    SimPAL::setPlant([&](const float idt) {
+      time += idt;
+      const double omega = 2.5 * std::sin(time * 1.3); //rad/s
+      const double dTheta = omega * idt;
+      const double chord = std::fabs(dTheta) < 1e-9 ? speed * idt : speed * idt * std::sin(dTheta / 2) / (dTheta / 2);
+      x += chord * std::cos(theta + dTheta / 2);
+      y += chord * std::sin(theta + dTheta / 2);
+      theta += dTheta;
+
+      leftMM += (speed - omega * track / 2) * idt;
+      rightMM += (speed + omega * track / 2) * idt;
+      SimPAL::setEncoder(1, static_cast<int>(leftMM / mmPerTick));
+      SimPAL::setEncoder(3, static_cast<int>(rightMM / mmPerTick));
+    }, plantPeriod);
+
+    const float scale = static_cast<float>(mmPerTick);
+    const float turnScale = static_cast<float>(2 * mmPerTick / track) * radianToDegree;
+    Odometry odom(SkidSteerModelParams<1>({2_m, 5_m}, QuadEncoder(1, 2), QuadEncoder(3, 4)), scale, turnScale);
+
+    Result result{0, 0, 0};
+    for (unsigned long elapsed = 0; elapsed < duration; elapsed += iperiod) {
+      SimPAL::run(iperiod);
+      odom.step();
+
+      const OdomState state = odom.getState();
+      result.maxError = std::fmax(result.maxError, std::hypot(state.x - x, state.y - y));
+    }
+
+    const OdomState state = odom.getState();
+    result.finalError = std::hypot(state.x - x, state.y - y);
+    result.headingError = std::remainder(state.theta - theta * 180 / 3.14159265358979, 360.0);
+    return result;
+  }
+}
+
+int main() {
+  bool passed = true;
+
+  for (const unsigned long period : {5ul, 10ul, 15ul}) {
+    const Result result = run(period);
+    std::printf("period %2lu ms: max error %6.2f mm, final error %6.2f mm, heading error %.3f deg\n", period, result.maxError, result.finalError, result.headingError);
+
+    //Exact arcs stay within a millimetre here; first order Euler is off by centimetres
+    passed = passed && result.maxError < 1 && std::fabs(result.headingError) < 0.05;
+  }
+
+  if (!passed)
+    std::printf("FAIL: odometry error is larger than expected\n");
+  return passed ? 0 : 1;
+}
@@ -0,0 +1,160 @@
+/**
+ * Replays a log written by an OdomRecorder through Odometry on a computer, as fast as it will go.
+ * The same samples go through plain odometry and through odometry with a PoseEstimator, so
+ * configurations and estimators can be compared on exactly the same run. Poses are relative to
+ * where the robot was at the first sample. Build it with "make odomreplay" and run it with no
+ * arguments for usage.
+ *
+ * To try another estimator, add it to the candidates below.
+ */
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include "PAL/simPAL.h"
+#include "odometry/odomRecorder.h"
+#include "odometry/odometry.h"
+#include "odometry/poseEstimator.h"
+
+using namespace okapi;
+
+namespace {
+  /**
+   * Hands Odometry the logged value of one channel
+   */
+  class ReplaySensor : public RotarySensor {
+  public:
+    ReplaySensor():
+      value(0) {}
+
+    int get() override { return value; }
+    void reset() override { value = 0; }
+
+    int value;
+  };
+
+  class Candidate {
+  public:
+    Candidate(const std::string& iname, const OdomParams& iparams):
+      name(iname),
+      odom(iparams) {}
+
+    std::string name;
+    Odometry odom;
+  };
+
+  void usage() {
+    std::fprintf(stderr,
+      "usage: odomReplay <log> skid <scale> <turnScale> [mismatch] [options]\n"
+      "       odomReplay <log> wheels <leftScale> <leftOffset> <rightScale> <rightOffset> [<lateralScale> <lateralOffset>] [options]\n"
+      "options:\n"
+      "  --gyro <scale>  fuse the logged gyro, in degrees per unit\n"
+      "  --trace         print every candidate's pose after every sample\n");
+  }
+}
+
+int main(int argc, char **argv) {
+  if (argc < 5) {
+    usage();
+    return 1;
+  }
+
+  std::vector<std::string> args(argv + 1, argv + argc);
+  float gyroScale = 0;
+  bool trace = false;
+
+  std::vector<float> numbers;
+  for (std::size_t i = 2; i < args.size(); i++) {
+    if (args[i] == "--gyro" && i + 1 < args.size())
+      gyroScale = std::strtof(args[++i].c_str(), nullptr);
+    else if (args[i] == "--trace")
+      trace = true;
+    else
+      numbers.push_back(std::strtof(args[i].c_str(), nullptr));
+  }
+
+  const bool isSkid = args[1] == "skid";
+  if ((isSkid && (numbers.size() < 2 || numbers.size() > 3)) ||
+      (!isSkid && (args[1] != "wheels" || (numbers.size() != 4 && numbers.size() != 6)))) {
+    usage();
+    return 1;
+  }
+
+  SimPAL::reset();
+
+  OdomLogReader reader;
+  if (!reader.open(args[0].c_str())) {
+    std::fprintf(stderr, "%s is missing or is not an odometry log\n", args[0].c_str());
+    return 1;
+  }
+
+  std::array<std::shared_ptr<ReplaySensor>, OdomSample::channels> sensors;
+  for (auto& sensor : sensors)
+    sensor = std::make_shared<ReplaySensor>();
+
+  const OdomGyroParams gyro = gyroScale != 0 ? OdomGyroParams(sensors[3], gyroScale) : OdomGyroParams();
+  const SkidSteerModelParams<1> model({2_m, 3_m}, sensors[0], sensors[1]);
+
+  OdomParams params = isSkid ? OdomParams(model, numbers[0], numbers[1], gyro)
+                             : OdomParams(model,
+                                          TrackingWheel(sensors[0], numbers[0], numbers[1]),
+                                          TrackingWheel(sensors[1], numbers[2], numbers[3]),
+                                          numbers.size() == 6 ? TrackingWheel(sensors[2], numbers[4], numbers[5]) : TrackingWheel(),
+                                          gyro);
+  if (isSkid && numbers.size() == 3)
+    params.mismatch = numbers[2];
+
+  std::vector<std::unique_ptr<Candidate>> candidates;
+  candidates.emplace_back(new Candidate("odometry", params));
+  params.estimator = std::make_shared<PoseEstimator>();
+  candidates.emplace_back(new Candidate("estimator", params));
+
+  OdomSample sample;
+  std::array<int, OdomSample::channels> origin{};
+  unsigned long count = 0, firstTimestamp = 0, lastTimestamp = 0;
+  const auto start = std::chrono::steady_clock::now();
+
+  while (reader.next(sample)) {
+    //The log usually starts partway through the robot's run, while the candidates start from
+    //zero ticks at the origin. Take the first sample as the origin, otherwise the first step
+    //would count every tick before the log started as motion
+    if (count == 0) {
+      firstTimestamp = sample.timestamp;
+      for (std::size_t i = 0; i < OdomSample::channels; i++)
+        origin[i] = sample.ticks[i];
+    }
+
+    //Line the simulated clock up with the log, so dt and timestamps come out as they did on the robot
+    const unsigned long elapsed = sample.timestamp - firstTimestamp;
+    PAL::delayMicroseconds(elapsed - PAL::micros());
+    lastTimestamp = sample.timestamp;
+
+    for (std::size_t i = 0; i < OdomSample::channels; i++)
+      sensors[i]->value = sample.ticks[i] - origin[i];
+
+    for (auto& candidate : candidates) {
+      candidate->odom.step();
+
+      if (trace) {
+        const OdomState state = candidate->odom.getState();
+        std::printf("%lu,%s,%.2f,%.2f,%.3f\n", elapsed, candidate->name.c_str(), state.x, state.y, state.theta);
+      }
+    }
+
+    count++;
+  }
+
+  const double hostSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  const double logSeconds = static_cast<double>(lastTimestamp - firstTimestamp) / 1000000.0;
+  std::printf("%lu samples, %.2f s of log replayed in %.4f s\n", count, logSeconds, hostSeconds);
+
+  for (auto& candidate : candidates) {
+    const OdomState state = candidate->odom.getState();
+    std::printf("%-10s x %9.2f mm  y %9.2f mm  theta %8.3f deg\n", candidate->name.c_str(), state.x, state.y, state.theta);
+  }
+
+  return 0;
+}